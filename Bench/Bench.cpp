@@ -0,0 +1,281 @@
+// ItlwmCLI Bench.cpp
+// Copyright 2026 by Calebh101
+//
+// Micro-benchmarks for the parts of ItlwmCLI that run on every frame or every command: parsing a command line, sorting the scan
+// list, scaling the graph, keeping the RSSI stats, and building and drawing a whole frame into an offscreen screen at a few
+// terminal sizes and history lengths. None of it talks to the driver, so it runs anywhere the TUI builds.
+//
+// Build it with 'cmake --build build --target bench_itlwmcli', and run it with '--json' to get numbers a script can compare
+// between commits.
+
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <fmt/format.h>
+#include "json.hpp"
+#include "Random.h"
+#include "RingBuffer.h"
+#include "RssiStats.h"
+#include "Tokenizer.h"
+#include "View.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+using bench_clock = std::chrono::steady_clock;
+
+#define BENCH_MIN_TIME_MS 200  // How long each benchmark runs for, at least
+#define BENCH_SAMPLES 7        // How many batches we time; we report the median and the fastest
+
+struct bench_result {
+    std::string name;
+    uint64_t iterations; // Per batch
+    double median; // Nanoseconds per iteration
+    double fastest;
+};
+
+// Keeps the compiler from throwing away work whose result we never look at
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Works out how many iterations fill a slice of the time we've got, then times BENCH_SAMPLES batches of that many
+bench_result measure(const std::string& name, int64_t minTimeMs, const std::function<void(uint64_t)>& batch) {
+    auto elapsed = [&](uint64_t iterations) {
+        auto start = bench_clock::now();
+        batch(iterations);
+        return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+    };
+
+    double target = minTimeMs * 1e6 / BENCH_SAMPLES;
+    uint64_t iterations = 1;
+
+    while (true) {
+        double took = elapsed(iterations);
+        if (took >= target / 4 || iterations >= (1ULL << 30)) {
+            iterations = std::max<uint64_t>(1, static_cast<uint64_t>(iterations * target / std::max(took, 1.0)));
+            break;
+        }
+        iterations *= 8;
+    }
+
+    std::vector<double> samples;
+    for (int i = 0; i < BENCH_SAMPLES; i++) samples.push_back(elapsed(iterations) / iterations);
+    std::sort(samples.begin(), samples.end());
+    return {name, iterations, samples[samples.size() / 2], samples.front()};
+}
+
+// What to run and where the results go
+struct bench_context {
+    std::string filter; // Only benchmarks with this in their name
+    int64_t minTimeMs;
+    bool asJson;
+    std::vector<bench_result> results;
+
+    void run(const std::string& name, const std::function<void(uint64_t)>& batch) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+        results.push_back(measure(name, minTimeMs, batch));
+        const bench_result& result = results.back();
+        if (!asJson) std::cout << fmt::format("{:<28} {:>12.1f} ns/op {:>12.1f} ns/op fastest {:>12} per batch", result.name, result.median, result.fastest, result.iterations) << std::endl;
+    }
+};
+
+ioctl_network_info makeNetwork(Random& random, int index) {
+    ioctl_network_info network;
+    std::memset(&network, 0, sizeof(network));
+    std::string ssid = fmt::format("Network {}", index);
+    std::memcpy(network.ssid, ssid.data(), std::min(ssid.size(), sizeof(network.ssid)));
+    network.rssi = static_cast<int16_t>(random.range(-95, -30));
+    network.noise = static_cast<int16_t>(random.range(-100, -85));
+    network.channel = random.range(1, 165);
+    network.rsn_protos = random.next() % 2;
+    return network;
+}
+
+network_info_list_t makeNetworks(Random& random, int count) {
+    network_info_list_t list;
+    std::memset(&list, 0, sizeof(list));
+    list.count = std::min(count, MAX_NETWORK_LIST_LENGTH);
+    for (int i = 0; i < list.count; i++) list.networks[i] = makeNetwork(random, i);
+    return list;
+}
+
+itlwm_state makeState(Random& random, int networks) {
+    itlwm_state state;
+    std::memset(&state, 0, sizeof(state));
+    state.snapshot = {true, true, true, true, true, true, true};
+    state.power = true;
+    state.state = ITL80211_S_RUN;
+    std::strcpy(state.ssid, "Network 0");
+    std::strcpy(state.platform.driver_info_str, "v2.3.0");
+    std::strcpy(state.platform.device_info_str, "AX201");
+    state.networks = makeNetworks(random, networks);
+    state.station.rssi = -55;
+    state.station.channel = 36;
+    state.station.op_mode = ITL80211_MODE_11AX;
+    return state;
+}
+
+void benchParse(bench_context& bench) {
+    const std::vector<std::pair<std::string, std::string>> lines = {
+        {"short", "power on"},
+        {"quoted", "connect \"Coffee Shop WiFi\" 'hunter2 with spaces'"},
+        {"escaped", "echo one\\ two \"three \\\"four\\\"\" five six seven eight nine ten"},
+    };
+
+    std::vector<command_token> tokens;
+    std::vector<std::string> args;
+
+    for (const auto& line : lines) {
+        bench.run(fmt::format("parse/{}", line.first), [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                splitArguments(line.second, tokens, args);
+                keep(args);
+            }
+        });
+    }
+}
+
+// What the renderer pays whenever a new scan list comes in (it keeps the sorted copy until the list's version changes): copy
+// it out of the snapshot, then sort it by strength
+void benchSort(bench_context& bench) {
+    for (int count : {8, 32, 100, MAX_NETWORK_LIST_LENGTH}) {
+        Random random(count);
+        network_info_list_t original = makeNetworks(random, count);
+        network_info_list_t list;
+
+        bench.run(fmt::format("sort/{}", count), [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                std::memcpy(&list, &original, sizeof(list)); // Unsorted again, like a fresh scan list
+                std::sort(list.networks, list.networks + list.count, compareNetworkStrength);
+                keep(list);
+            }
+        });
+    }
+}
+
+void benchGraph(bench_context& bench) {
+    for (size_t history : {100, 10000}) {
+        RingBuffer<int16_t> buffer(history);
+        Random random(history);
+        for (size_t i = 0; i < history; i++) buffer.push(static_cast<int16_t>(random.range(-80, -40)));
+
+        for (int width : {40, 160}) {
+            graph_data graph{false, -80, -40, buffer.view(), {}};
+
+            bench.run(fmt::format("graph/live/{}x{}", history, width), [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; i++) keep(makeGraph(graph, width, 20));
+            });
+        }
+    }
+
+    for (int width : {40, 160}) {
+        Random random(width);
+        graph_data graph{true, 0, 0, {}, {}};
+
+        for (int i = 0; i < width / BAR_WIDTH; i++) {
+            rssi_bucket bucket{0, 0, 0, 0};
+            for (int j = 0; j < 16; j++) bucket.add(static_cast<int16_t>(random.range(-80, -40)));
+            graph.zoomed.push_back(bucket);
+        }
+
+        setGraphRange(graph, rssi_summary{0, 0, 0, 0});
+
+        bench.run(fmt::format("graph/zoomed/{}", width), [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(makeGraph(graph, width, 20));
+        });
+    }
+}
+
+void benchStats(bench_context& bench) {
+    for (size_t window : {100, 10000}) {
+        RssiStats stats(window);
+        Random random(window);
+        std::vector<int16_t> values(4096);
+        for (int16_t& value : values) value = static_cast<int16_t>(random.range(-90, -30));
+        size_t next = 0;
+
+        bench.run(fmt::format("stats/push/{}", window), [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) stats.push(values[next++ % values.size()]);
+        });
+
+        bench.run(fmt::format("stats/summary/{}", window), [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(stats.summary());
+        });
+    }
+}
+
+// A whole frame, the way the renderer makes one: build it, then draw it into a screen that's never printed
+void benchFrame(bench_context& bench) {
+    const std::vector<std::pair<int, int>> sizes = {{80, 24}, {160, 48}, {320, 90}};
+
+    for (size_t history : {100, 10000}) {
+        Random random(history);
+        itlwm_state state = makeState(random, 64);
+        network_info_list_t networks = state.networks;
+        std::sort(networks.networks, networks.networks + networks.count, compareNetworkStrength);
+
+        RingBuffer<int16_t> buffer(history);
+        RssiStats stats(history);
+
+        for (size_t i = 0; i < history; i++) {
+            int16_t value = static_cast<int16_t>(random.range(-80, -40));
+            buffer.push(value);
+            stats.push(value);
+        }
+
+        std::vector<std::string> logLines;
+        for (int i = 0; i < VISIBLE_LOG_LINES; i++) logLines.push_back(fmt::format("Log line {} with a bit of text in it", i));
+
+        for (const auto& size : sizes) {
+            auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(size.first), ftxui::Dimension::Fixed(size.second));
+
+            bench.run(fmt::format("frame/{}x{}/{}", size.first, size.second, history), [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; i++) {
+                    view_input view{&state, &networks, &logLines, 100, 100 + logLines.size(), 0, stats.summary(), {false, 0, 0, buffer.view(), {}}, 0, station_metric_rssi, "ItlwmCLI Bench", "", ftxui::text(""), {}, {size.first, size.second}};
+                    ftxui::Render(screen, buildView(view));
+                    keep(screen);
+                }
+            });
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    bench_context bench{"", BENCH_MIN_TIME_MS, false, {}};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--json") {
+            bench.asJson = true;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            bench.filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            bench.minTimeMs = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: bench_itlwmcli [--json] [--filter <substring>] [--min-time <ms per benchmark>]" << std::endl;
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    benchParse(bench);
+    benchSort(bench);
+    benchGraph(bench);
+    benchStats(bench);
+    benchFrame(bench);
+
+    if (bench.asJson) {
+        json out = json::array();
+        for (const bench_result& result : bench.results) out.push_back({{"name", result.name}, {"iterations", result.iterations}, {"median_ns", result.median}, {"fastest_ns", result.fastest}});
+        std::cout << out.dump(4) << std::endl;
+    }
+
+    return 0;
+}
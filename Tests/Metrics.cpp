@@ -0,0 +1,155 @@
+// ItlwmCLI Metrics.cpp
+// Copyright 2026 by Calebh101
+//
+// Checks what renderMetrics() makes of a few snapshots, mostly that everything about our connection shows up while we're
+// connected (and doesn't while we're not). Run it with 'ctest' (or run test_metrics yourself); it prints what failed and
+// exits with 1 if anything did.
+
+#include <fmt/format.h>
+#include "Metrics.h"
+#include "Snapshot.h"
+#include "TimedBackend.h"
+#include <cstring>
+#include <string>
+
+#ifdef ITLWMCLI_SIMULATED
+    #include "SimulatedBackend.h"
+#endif
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { failures++; fmt::print("FAIL {}:{}: {}\n", __FILE__, __LINE__, fmt::format(__VA_ARGS__)); } } while (false)
+
+static bool hasLine(const std::string& text, const std::string& line) {
+    return text.find(line + "\n") != std::string::npos;
+}
+
+static bool hasMetric(const std::string& text, const std::string& name) {
+    return text.find("\n" + name + " ") != std::string::npos || text.find("\n" + name + "{") != std::string::npos;
+}
+
+// Powered on and associated to "Home" at -55 dBm, as the refresher would've published it
+static itlwm_state connectedState() {
+    itlwm_state state{};
+    state.power = true;
+    state.state = ITL80211_S_RUN;
+    std::strcpy(state.ssid, "Home");
+    state.station.rssi = -55;
+    state.station.noise = -95;
+    state.station.channel = 36;
+    state.station.op_mode = ITL80211_MODE_11AC;
+    state.networks.count = 3;
+    state.snapshot.power_ok = state.snapshot.state_ok = state.snapshot.ssid_ok = state.snapshot.networks_ok = state.snapshot.station_ok = true;
+    return state;
+}
+
+static void testConnected(const BackendLatency& latency) {
+    std::string text;
+    renderMetrics(connectedState(), true, latency, text);
+
+    CHECK(hasLine(text, "itlwm_up 1"), "not up:\n{}", text);
+    CHECK(hasLine(text, "itlwm_power_on 1"), "not on:\n{}", text);
+    CHECK(hasLine(text, "itlwm_state{state=\"run\"} 1"), "not running:\n{}", text);
+    CHECK(hasLine(text, "itlwm_rssi_dbm -55"), "no RSSI:\n{}", text);
+    CHECK(hasLine(text, "itlwm_noise_dbm -95"), "no noise:\n{}", text);
+    CHECK(hasLine(text, "itlwm_channel 36"), "no channel:\n{}", text);
+    CHECK(hasLine(text, "itlwm_phy_mode{mode=\"11ac\"} 1"), "no PHY mode:\n{}", text);
+    CHECK(hasLine(text, "itlwm_connected_network{ssid=\"Home\"} 1"), "no SSID:\n{}", text);
+    CHECK(hasLine(text, "itlwm_scan_networks 3"), "no scan list:\n{}", text);
+    CHECK(text.size() >= 6 && text.compare(text.size() - 6, 6, "# EOF\n") == 0, "doesn't end in # EOF");
+}
+
+static void testNotConnected(const BackendLatency& latency) {
+    std::string text;
+    itlwm_state state = connectedState();
+    state.snapshot.station_ok = false; // The driver wouldn't tell us
+    renderMetrics(state, true, latency, text);
+    CHECK(!hasMetric(text, "itlwm_rssi_dbm") && !hasMetric(text, "itlwm_connected_network"), "connection without station info:\n{}", text);
+
+    state = connectedState();
+    state.station.rssi = RSSI_UNAVAILABLE_THRESHOLD; // What it says while it doesn't really know
+    renderMetrics(state, true, latency, text);
+    CHECK(!hasMetric(text, "itlwm_rssi_dbm"), "made-up RSSI exported:\n{}", text);
+
+    state = connectedState();
+    state.state = ITL80211_S_SCAN;
+    renderMetrics(state, true, latency, text);
+    CHECK(!hasMetric(text, "itlwm_rssi_dbm") && hasLine(text, "itlwm_state{state=\"scan\"} 1"), "connection while scanning:\n{}", text);
+
+    renderMetrics(connectedState(), false, latency, text);
+    CHECK(hasLine(text, "itlwm_up 0") && !hasMetric(text, "itlwm_rssi_dbm"), "something before anything was published:\n{}", text);
+}
+
+// SSIDs are just bytes, but label values have to be UTF-8 (or Prometheus rejects the whole scrape)
+static void testSsidLabels(const BackendLatency& latency) {
+    std::string text;
+    itlwm_state state = connectedState();
+    std::strcpy(state.ssid, "Caf\xe9 \"1\"\\"); // Latin-1, with things that need escaping
+    renderMetrics(state, true, latency, text);
+    CHECK(hasLine(text, "itlwm_connected_network{ssid=\"Caf\xc3\xa9 \\\"1\\\"\\\\\"} 1"), "Latin-1 SSID not made UTF-8:\n{}", text);
+
+    std::strcpy(state.ssid, "caf\xc3\xa9 \xf0\x9f\x93\xb6"); // Already UTF-8, so it stays the way it is
+    renderMetrics(state, true, latency, text);
+    CHECK(hasLine(text, "itlwm_connected_network{ssid=\"caf\xc3\xa9 \xf0\x9f\x93\xb6\"} 1"), "UTF-8 SSID changed:\n{}", text);
+
+    std::strcpy(state.ssid, "\xe2\x82\xff\xed\xa0\x80"); // Cut short, not UTF-8 at all, and a surrogate
+    renderMetrics(state, true, latency, text);
+    CHECK(hasLine(text, "itlwm_connected_network{ssid=\"\xc3\xa2\xc2\x82\xc3\xbf\xc3\xad\xc2\xa0\xc2\x80\"} 1"), "invalid SSID not made UTF-8:\n{}", text);
+}
+
+static void testLatency() {
+    BackendLatency latency;
+    for (int i = 0; i < 10; i++) latency[backend_call_station_info].record(2000); // 2ms each
+    std::string text;
+    renderMetrics(connectedState(), true, latency, text);
+    const char* name = backendCallToString(backend_call_station_info);
+
+    CHECK(hasLine(text, fmt::format("itlwm_backend_call_duration_seconds_bucket{{call=\"{}\",le=\"0.001\"}} 0", name)), "2ms counted under 1ms:\n{}", text);
+    CHECK(hasLine(text, fmt::format("itlwm_backend_call_duration_seconds_bucket{{call=\"{}\",le=\"0.0025\"}} 10", name)), "2ms not counted under 2.5ms:\n{}", text);
+    CHECK(hasLine(text, fmt::format("itlwm_backend_call_duration_seconds_count{{call=\"{}\"}} 10", name)), "wrong count:\n{}", text);
+}
+
+#ifdef ITLWMCLI_SIMULATED
+// The same thing, but with the snapshot filled in from a (simulated) driver the way the refresher does it, so the ok flags
+// mean what the calls returned
+static void testSimulated(const BackendLatency& latency) {
+    simulation_options options;
+    options.tickInterval = 0;
+    options.dropChance = 0;
+    SimulatedBackend backend(options);
+    for (int i = 0; i < 20; i++) backend.step();
+
+    itlwm_state state{};
+    state.snapshot.power_ok = backend.getPowerState(&state.power);
+    state.snapshot.state_ok = backend.get80211State(&state.state);
+    state.snapshot.ssid_ok = backend.getNetworkSsid(state.ssid);
+    state.snapshot.networks_ok = backend.getNetworkList(&state.networks);
+    state.snapshot.station_ok = backend.getStationInfo(&state.station) == KERN_SUCCESS;
+
+    std::string text;
+    renderMetrics(state, true, latency, text);
+    CHECK(state.state == ITL80211_S_RUN, "simulated driver isn't connected (state {})", state.state);
+    CHECK(hasLine(text, fmt::format("itlwm_rssi_dbm {}", state.station.rssi)), "no RSSI from the simulated driver:\n{}", text);
+    CHECK(hasMetric(text, "itlwm_connected_network"), "no SSID from the simulated driver:\n{}", text);
+}
+#endif
+
+int main() {
+    BackendLatency latency;
+    testConnected(latency);
+    testNotConnected(latency);
+    testSsidLabels(latency);
+    testLatency();
+
+    #ifdef ITLWMCLI_SIMULATED
+        testSimulated(latency);
+    #endif
+
+    if (failures > 0) {
+        fmt::print("{} check(s) failed\n", failures);
+        return 1;
+    }
+
+    fmt::print("All metrics checks passed\n");
+    return 0;
+}
@@ -0,0 +1,278 @@
+// ItlwmCLI Analyze.h
+// Copyright 2026 by Calebh101
+//
+// Crunches captures (see Capture.h) into a report, for 'ItlwmCLI analyze': RSSI percentiles per SSID, how long we spent in
+// each 802.11 state, and how many times we got disconnected.
+//
+// Every keyframe is a place decoding can start from, so each capture is cut into shards of a few keyframes and the shards
+// go to a pool of threads. Each thread adds up its own totals (nothing's shared while they work), and the totals get merged
+// once they're all done. Two things cross shard boundaries: a disconnect right on one, and a keyframe repeating a scan (or
+// station info) the shard before it already counted. So each shard remembers how it started and ended, holds on to what its
+// first record would count, and those get stitched together at the end.
+
+#ifndef Analyze_h
+#define Analyze_h
+
+#include "Capture.h"
+#include "View.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define ANALYZE_SHARD_KEYFRAMES 6  // How many keyframes (about a minute of capture) a shard covers
+#define ANALYZE_RSSI_BUCKETS 128   // One per dBm, from 0 down to -127
+
+// Every RSSI value we saw for something, one bucket per dBm, so merging is adding and percentiles are exact
+struct rssi_distribution {
+    uint64_t counts[ANALYZE_RSSI_BUCKETS] = {};
+    uint64_t total = 0;
+    int64_t sum = 0;
+
+    void add(int rssi) {
+        counts[std::clamp(-rssi, 0, ANALYZE_RSSI_BUCKETS - 1)]++;
+        total++;
+        sum += rssi;
+    }
+
+    void merge(const rssi_distribution& other) {
+        for (int i = 0; i < ANALYZE_RSSI_BUCKETS; i++) counts[i] += other.counts[i];
+        total += other.total;
+        sum += other.sum;
+    }
+
+    // The RSSI that 'fraction' (0 to 1) of the values are at or below, so 0.1 is about the weakest we usually saw
+    int percentile(double fraction) const {
+        if (total == 0) return 0;
+        uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * total)));
+        uint64_t seen = 0;
+
+        for (int i = ANALYZE_RSSI_BUCKETS - 1; i >= 0; i--) { // Weakest first
+            seen += counts[i];
+            if (seen >= target) return -i;
+        }
+
+        return 0;
+    }
+
+    double mean() const {
+        return total == 0 ? 0.0 : static_cast<double>(sum) / total;
+    }
+};
+
+// What one capture (or all of them together) added up to
+struct capture_analysis {
+    std::unordered_map<std::string, rssi_distribution> scanned; // Per SSID, from the scan list
+    std::unordered_map<std::string, rssi_distribution> connected; // Per SSID, our own RSSI while we were connected to it
+    std::map<std::string, int64_t> stateTime; // Microseconds spent in each state, by parse80211State()
+    uint64_t disconnects = 0;
+    uint64_t records = 0;
+    int64_t duration = 0; // Microseconds
+
+    void merge(const capture_analysis& other) {
+        for (const auto& ssid : other.scanned) scanned[ssid.first].merge(ssid.second);
+        for (const auto& ssid : other.connected) connected[ssid.first].merge(ssid.second);
+        for (const auto& state : other.stateTime) stateTime[state.first] += state.second;
+        disconnects += other.disconnects;
+        records += other.records;
+        duration += other.duration;
+    }
+};
+
+// A capture we're analyzing
+struct analyze_file {
+    std::string path;
+    std::unique_ptr<CaptureFile> file;
+    uint64_t records = 0; // Filled in by run()
+};
+
+class CaptureAnalyzer {
+public:
+    // Returns false if 'path' can't be opened or isn't a capture we understand
+    bool add(const std::string& path) {
+        auto file = std::make_unique<CaptureFile>();
+        if (!file->open(path)) return false;
+        files.push_back({path, std::move(file), 0});
+        return true;
+    }
+
+    const std::vector<analyze_file>& captures() const {
+        return files;
+    }
+
+    // Analyze everything that's been added, on 'threads' threads (<= 0 for one per core)
+    capture_analysis run(int threads) {
+        std::vector<Shard> shards;
+
+        for (size_t i = 0; i < files.size(); i++) {
+            const CaptureFile& file = *files[i].file;
+            const std::vector<capture_keyframe>& index = file.index();
+
+            for (size_t k = 0; k < index.size(); k += ANALYZE_SHARD_KEYFRAMES) {
+                size_t next = k + ANALYZE_SHARD_KEYFRAMES;
+                Shard shard;
+                shard.file = i;
+                shard.begin = index[k].offset;
+                shard.end = next < index.size() ? index[next].offset : file.recordsEnd();
+                shard.endTime = next < index.size() ? index[next].time : file.endTime();
+                shards.push_back(shard);
+            }
+        }
+
+        if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::max(1, std::min<int>(threads, static_cast<int>(shards.size())));
+
+        std::vector<capture_analysis> totals(threads); // One per thread, so they never touch each other's
+        std::atomic<size_t> nextShard{0};
+        std::vector<std::thread> workers;
+
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                auto scratch = std::make_unique<Scratch>(); // A couple of scan lists, which are a bit big for the stack
+
+                for (size_t i = nextShard++; i < shards.size(); i = nextShard++) {
+                    analyzeShard(shards[i], *scratch, totals[t]);
+                }
+            });
+        }
+
+        for (std::thread& worker : workers) worker.join();
+
+        capture_analysis result;
+        for (const capture_analysis& total : totals) result.merge(total);
+
+        for (size_t i = 0; i < shards.size(); i++) {
+            const Shard& shard = shards[i];
+            const Shard* before = i > 0 && shards[i - 1].file == shard.file && shards[i - 1].any ? &shards[i - 1] : nullptr;
+            files[shard.file].records += shard.records;
+            if (before != nullptr && shard.any && before->lastRunning && !shard.firstRunning) result.disconnects++; // Right on the boundary
+
+            if (before == nullptr || before->lastScan != shard.firstScan) {
+                for (const auto& sample : shard.firstScanned) result.scanned[sample.first].add(sample.second);
+            }
+
+            if (before == nullptr || before->lastStation != shard.firstStation) {
+                for (const auto& sample : shard.firstConnected) result.connected[sample.first].add(sample.second);
+            }
+        }
+
+        for (const analyze_file& file : files) result.duration += file.file->endTime() - file.file->startTime();
+        return result;
+    }
+
+private:
+    struct Shard {
+        size_t file;
+        size_t begin; // Where its first record (a keyframe) starts
+        size_t end; // Where the next shard's starts
+        int64_t endTime; // When the next shard starts, so we know how long the last state lasted
+        uint64_t records = 0;
+        bool any = false; // If it had any records at all
+        bool firstRunning = false; // If we were connected at its first record
+        bool lastRunning = false; // ...and at its last
+        uint64_t firstScan = 0, lastScan = 0; // Fingerprints of the scan list at its first and last records
+        uint64_t firstStation = 0, lastStation = 0; // ...and of the station info
+        std::vector<std::pair<std::string, int>> firstScanned; // What its first record would add, if it's not a repeat
+        std::vector<std::pair<std::string, int>> firstConnected;
+    };
+
+    struct Scratch {
+        itlwm_state state;
+        network_info_list_t previous;
+    };
+
+    std::vector<analyze_file> files;
+
+    // FNV-1a, just to tell if two shards saw the same thing on either side of a boundary
+    static uint64_t fingerprint(const void* data, size_t size) {
+        uint64_t hash = 14695981039346656037ULL;
+
+        for (size_t i = 0; i < size; i++) {
+            hash ^= static_cast<const uint8_t*>(data)[i];
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    static uint64_t fingerprint(const network_info_list_t& networks) {
+        return fingerprint(networks.networks, sizeof(ioctl_network_info) * std::clamp(networks.count, 0, MAX_NETWORK_LIST_LENGTH)) ^ static_cast<uint64_t>(networks.count);
+    }
+
+    static bool isRunning(const itlwm_state& state) {
+        return state.snapshot.state_ok && state.state == ITL80211_S_RUN;
+    }
+
+    void analyzeShard(Shard& shard, Scratch& scratch, capture_analysis& total) {
+        const CaptureFile& file = *files[shard.file].file;
+        itlwm_state& state = scratch.state;
+        std::memset(&state, 0, sizeof(state));
+
+        size_t offset = shard.begin;
+        int64_t previousTime = 0;
+        bool running = false;
+        const uint8_t* record;
+        size_t length, next;
+
+        while (offset < shard.end && file.record(offset, record, length, next)) {
+            int64_t time;
+            uint8_t fields;
+            if (!peekCaptureRecord(record, length, time, fields)) break;
+            if (shard.any) total.stateTime[parse80211State(state.snapshot.state_ok, state.state)] += time - previousTime; // The state before this record lasted until now
+
+            if (fields & capture_field_networks) scratch.previous = state.networks;
+            station_info_t previousStation = state.station;
+            if (!decodeCaptureRecord(record, length, state)) break;
+            bool nowRunning = isRunning(state);
+
+            if (!shard.any) shard.firstRunning = nowRunning;
+            else if (running && !nowRunning) total.disconnects++;
+
+            // Keyframes repeat whatever hasn't changed, so only count a scan (or station info) when it's actually new
+            bool newScan = (fields & capture_field_networks) && (!shard.any || scratch.previous.count != state.networks.count || std::memcmp(scratch.previous.networks, state.networks.networks, sizeof(ioctl_network_info) * state.networks.count) != 0);
+            bool newStation = (fields & capture_field_station) && (!shard.any || std::memcmp(&previousStation, &state.station, sizeof(station_info_t)) != 0);
+
+            if (!shard.any) {
+                shard.firstScan = fingerprint(state.networks);
+                shard.firstStation = fingerprint(&state.station, sizeof(station_info_t));
+            }
+
+            if (newScan && state.snapshot.networks_ok) {
+                for (int i = 0; i < state.networks.count; i++) {
+                    const ioctl_network_info& network = state.networks.networks[i];
+                    if (network.ssid[0] == 0) continue; // Hidden
+                    std::string ssid(reinterpret_cast<const char*>(network.ssid), strnlen(reinterpret_cast<const char*>(network.ssid), MAX_SSID_LENGTH));
+                    if (shard.any) total.scanned[ssid].add(network.rssi);
+                    else shard.firstScanned.push_back({ssid, network.rssi}); // Might be a repeat of the last shard's
+                }
+            }
+
+            if (newStation && nowRunning && state.snapshot.ssid_ok && state.station.rssi < 0 && state.station.rssi > RSSI_UNAVAILABLE_THRESHOLD) {
+                std::string ssid(state.ssid, strnlen(state.ssid, MAX_SSID_LENGTH));
+                if (shard.any) total.connected[ssid].add(state.station.rssi);
+                else shard.firstConnected.push_back({ssid, state.station.rssi});
+            }
+
+            running = nowRunning;
+            previousTime = time;
+            shard.any = true;
+            shard.records++;
+            offset = next;
+        }
+
+        if (shard.any) total.stateTime[parse80211State(state.snapshot.state_ok, state.state)] += std::max<int64_t>(0, shard.endTime - previousTime);
+        shard.lastRunning = running;
+        shard.lastScan = fingerprint(state.networks);
+        shard.lastStation = fingerprint(&state.station, sizeof(station_info_t));
+        total.records += shard.records;
+    }
+};
+
+#endif /* Analyze_h */
@@ -0,0 +1,62 @@
+// ItlwmCLI Backend.h
+// Copyright 2026 by Calebh101
+//
+// The interface everything in ItlwmCLI uses to talk to itlwm. It mirrors ClientKit's Api.h one-to-one, so swapping the real
+// driver for the simulator (or anything else) doesn't change how the rest of the app behaves.
+
+#ifndef Backend_h
+#define Backend_h
+
+#include "Api.h"
+#include <string>
+
+class Backend {
+public:
+    virtual ~Backend() = default;
+
+    virtual std::string name() const = 0; // What we tell the user in 'about'
+
+    virtual bool getPlatformInfo(platform_info_t* result) = 0;
+    virtual bool getPowerState(bool* enabled) = 0;
+    virtual bool get80211State(uint32_t* state) = 0;
+    virtual bool getNetworkSsid(char* ssid) = 0;
+    virtual bool getNetworkBssid(char* bssid) = 0;
+    virtual bool getNetworkList(network_info_list_t* list) = 0;
+    virtual kern_return_t getStationInfo(station_info_t* info) = 0;
+
+    virtual bool connectNetwork(const char* ssid, const char* pwd) = 0;
+    virtual kern_return_t powerOn() = 0;
+    virtual kern_return_t powerOff() = 0;
+    virtual kern_return_t associateSsid(const char* ssid, const char* pwd) = 0;
+    virtual kern_return_t disassociateSsid(const char* ssid) = 0;
+
+    virtual void terminate() = 0; // Called once, right before we exit
+};
+
+#ifndef ITLWMCLI_SIMULATED // Builds without IOKit don't have ClientKit to forward to
+
+// The real deal: forwards everything straight to ClientKit (and therefore IOKit)
+class IOKitBackend : public Backend {
+public:
+    std::string name() const override { return "itlwm (IOKit)"; }
+
+    bool getPlatformInfo(platform_info_t* result) override { return get_platform_info(result); }
+    bool getPowerState(bool* enabled) override { return get_power_state(enabled); }
+    bool get80211State(uint32_t* state) override { return get_80211_state(state); }
+    bool getNetworkSsid(char* ssid) override { return get_network_ssid(ssid); }
+    bool getNetworkBssid(char* bssid) override { return get_network_bssid(bssid); }
+    bool getNetworkList(network_info_list_t* list) override { return get_network_list(list); }
+    kern_return_t getStationInfo(station_info_t* info) override { return get_station_info(info); }
+
+    bool connectNetwork(const char* ssid, const char* pwd) override { return connect_network(ssid, pwd); }
+    kern_return_t powerOn() override { return power_on(); }
+    kern_return_t powerOff() override { return power_off(); }
+    kern_return_t associateSsid(const char* ssid, const char* pwd) override { return associate_ssid(ssid, pwd); }
+    kern_return_t disassociateSsid(const char* ssid) override { return dis_associate_ssid(ssid); }
+
+    void terminate() override { api_terminate(); }
+};
+
+#endif
+
+#endif /* Backend_h */
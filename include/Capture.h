@@ -0,0 +1,483 @@
+// ItlwmCLI Capture.h
+// Copyright 2026 by Calebh101
+//
+// Recording what itlwm told us, so it can be played back later (--record and --replay). A capture is a small header followed
+// by one record per published snapshot. Each record has a monotonic timestamp, the ok flags, and only the parts of
+// itlwm_state that changed since the record before it (going by itlwm_state::versions), so a long session that mostly sits
+// still barely grows.
+//
+// Everything's written in the machine's own byte order and struct layouts (little-endian, and the same ClientKit structs
+// everywhere we build), and the header remembers the struct sizes so a capture from an incompatible build is refused
+// instead of misread.
+//
+// Header: "ITLWMCAP", u32 version, u16 sizeof(platform_info_t), u16 sizeof(ioctl_network_info), u16 sizeof(station_info_t), u16 0
+// Record: u32 length (of everything after it), i64 microseconds, u8 ok flags, u8 fields, then each field that's set, in order:
+//     power (u8), state (u32), SSID (u8 length + bytes), BSSID (u8 length + bytes), platform_info_t, scan list (u16 count +
+//     that many ioctl_network_info), station_info_t
+// Index: (i64 microseconds, u64 offset) for every keyframe, then i64 time of the last record, u64 keyframe count, "ITLWMIDX"
+//
+// Every so often (and always first) a record carries everything, which makes it a keyframe: you can start decoding from any
+// keyframe without looking at what came before it. The writer lists them all in an index at the end of the file when it
+// stops, so a reader can jump to any time by finding the keyframe before it and decoding forward from there. If the index is
+// missing (we crashed before we could write it), the reader just walks the records once to find the keyframes itself.
+
+#ifndef Capture_h
+#define Capture_h
+
+#include "Snapshot.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CAPTURE_MAGIC "ITLWMCAP"
+#define CAPTURE_INDEX_MAGIC "ITLWMIDX"
+#define CAPTURE_MAGIC_LENGTH 8
+#define CAPTURE_VERSION 1               // Bump it whenever a released build would misread the new format
+#define CAPTURE_INDEX_FOOTER_SIZE 24    // Last time, keyframe count and CAPTURE_INDEX_MAGIC
+#define CAPTURE_KEYFRAME_INTERVAL 10000 // Most milliseconds between keyframes, which is about as far as a seek has to decode
+#define CAPTURE_HEADER_SIZE 20
+#define CAPTURE_RECORD_HEADER_SIZE 14  // Length, timestamp, ok flags and fields
+#define CAPTURE_FLUSH_INTERVAL 1000     // Most milliseconds a record sits in memory before it's written out
+
+// Where a keyframe is: when it was recorded, and where its record (its length, that is) starts in the file
+struct capture_keyframe {
+    int64_t time;
+    uint64_t offset;
+};
+
+// Which parts of itlwm_state a record carries
+enum capture_field {
+    capture_field_power = 1 << 0,
+    capture_field_state = 1 << 1,
+    capture_field_ssid = 1 << 2,
+    capture_field_bssid = 1 << 3,
+    capture_field_platform = 1 << 4,
+    capture_field_networks = 1 << 5,
+    capture_field_station = 1 << 6,
+    capture_field_all = (1 << 7) - 1,
+};
+
+// Bit n is set if that part of the poll worked (so its value means something): ssid, bssid, state, power, platform, networks,
+// then station. These go out as-is in captures, to daemon subscribers and in the shared snapshot, so they can't move.
+inline uint8_t packSnapshotFlags(const itlwm_snapshot& snapshot) {
+    return (snapshot.ssid_ok << 0) | (snapshot.bssid_ok << 1) | (snapshot.state_ok << 2) | (snapshot.power_ok << 3) | (snapshot.platform_ok << 4) | (snapshot.networks_ok << 5) | (snapshot.station_ok << 6);
+}
+
+inline itlwm_snapshot unpackSnapshotFlags(uint8_t flags) {
+    return {(flags & (1 << 0)) != 0, (flags & (1 << 1)) != 0, (flags & (1 << 2)) != 0, (flags & (1 << 3)) != 0, (flags & (1 << 4)) != 0, (flags & (1 << 5)) != 0, (flags & (1 << 6)) != 0};
+}
+
+// What's changed between two sets of versions, as capture_fields
+inline uint8_t changedFields(const itlwm_versions& before, const itlwm_versions& after) {
+    uint8_t fields = 0;
+    if (before.power != after.power) fields |= capture_field_power;
+    if (before.state != after.state) fields |= capture_field_state;
+    if (before.ssid != after.ssid) fields |= capture_field_ssid;
+    if (before.bssid != after.bssid) fields |= capture_field_bssid;
+    if (before.platform != after.platform) fields |= capture_field_platform;
+    if (before.networks != after.networks) fields |= capture_field_networks;
+    if (before.station != after.station) fields |= capture_field_station;
+    return fields;
+}
+
+inline void writeCaptureHeader(std::vector<uint8_t>& out) {
+    uint32_t version = CAPTURE_VERSION;
+    uint16_t sizes[4] = {sizeof(platform_info_t), sizeof(ioctl_network_info), sizeof(station_info_t), 0};
+    out.insert(out.end(), CAPTURE_MAGIC, CAPTURE_MAGIC + CAPTURE_MAGIC_LENGTH);
+    out.insert(out.end(), reinterpret_cast<const uint8_t*>(&version), reinterpret_cast<const uint8_t*>(&version) + sizeof(version));
+    out.insert(out.end(), reinterpret_cast<const uint8_t*>(sizes), reinterpret_cast<const uint8_t*>(sizes) + sizeof(sizes));
+}
+
+// Returns the version, or 0 if this isn't a capture we can read
+inline uint32_t readCaptureHeader(const uint8_t* data, size_t size) {
+    if (size < CAPTURE_HEADER_SIZE || std::memcmp(data, CAPTURE_MAGIC, CAPTURE_MAGIC_LENGTH) != 0) return 0;
+    uint32_t version;
+    uint16_t sizes[4];
+    std::memcpy(&version, data + CAPTURE_MAGIC_LENGTH, sizeof(version));
+    std::memcpy(sizes, data + CAPTURE_MAGIC_LENGTH + sizeof(version), sizeof(sizes));
+    if (version != CAPTURE_VERSION) return 0;
+    if (sizes[0] != sizeof(platform_info_t) || sizes[1] != sizeof(ioctl_network_info) || sizes[2] != sizeof(station_info_t)) return 0;
+    return version;
+}
+
+// Appends one record with 'fields' out of 'state' to 'out'
+inline void encodeCaptureRecord(const itlwm_state& state, uint8_t fields, int64_t micros, std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    auto put = [&out](const void* data, size_t size) { out.insert(out.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size); };
+    auto putString = [&put](const char* value, size_t max) {
+        uint8_t length = static_cast<uint8_t>(strnlen(value, max));
+        put(&length, 1);
+        put(value, length);
+    };
+
+    uint32_t length = 0; // Filled in at the end
+    uint8_t flags = packSnapshotFlags(state.snapshot);
+    put(&length, sizeof(length));
+    put(&micros, sizeof(micros));
+    put(&flags, 1);
+    put(&fields, 1);
+
+    if (fields & capture_field_power) {
+        uint8_t power = state.power;
+        put(&power, 1);
+    }
+
+    if (fields & capture_field_state) put(&state.state, sizeof(state.state));
+    if (fields & capture_field_ssid) putString(state.ssid, sizeof(state.ssid));
+    if (fields & capture_field_bssid) putString(state.bssid, sizeof(state.bssid));
+    if (fields & capture_field_platform) put(&state.platform, sizeof(state.platform));
+
+    if (fields & capture_field_networks) {
+        uint16_t count = static_cast<uint16_t>(std::max(0, std::min(state.networks.count, MAX_NETWORK_LIST_LENGTH)));
+        put(&count, sizeof(count));
+        put(state.networks.networks, sizeof(ioctl_network_info) * count);
+    }
+
+    if (fields & capture_field_station) put(&state.station, sizeof(state.station));
+
+    length = static_cast<uint32_t>(out.size() - start - sizeof(length));
+    std::memcpy(out.data() + start, &length, sizeof(length));
+}
+
+// Reads a record's timestamp and fields without applying it. 'size' is everything after the length.
+inline bool peekCaptureRecord(const uint8_t* data, size_t size, int64_t& micros, uint8_t& fields) {
+    if (size < CAPTURE_RECORD_HEADER_SIZE - sizeof(uint32_t)) return false;
+    std::memcpy(&micros, data, sizeof(micros));
+    fields = data[sizeof(micros) + 1];
+    return true;
+}
+
+// Applies a record (everything after its length) on top of 'state', bumping the versions of whatever it changes the same way
+// the refresher does. Returns false if it's cut short or makes no sense, in which case 'state' might be half updated.
+inline bool decodeCaptureRecord(const uint8_t* data, size_t size, itlwm_state& state) {
+    size_t at = 0;
+    auto get = [&](void* value, size_t length) {
+        if (at + length > size) return false;
+        std::memcpy(value, data + at, length);
+        at += length;
+        return true;
+    };
+
+    auto getString = [&](char* value, size_t max) {
+        uint8_t length;
+        if (!get(&length, 1) || length > max) return false;
+        std::memset(value, 0, max);
+        return get(value, length);
+    };
+
+    int64_t micros;
+    uint8_t flags, fields;
+    if (!get(&micros, sizeof(micros)) || !get(&flags, 1) || !get(&fields, 1)) return false;
+    state.snapshot = unpackSnapshotFlags(flags);
+
+    if (fields & capture_field_power) {
+        uint8_t power;
+        if (!get(&power, 1)) return false;
+        state.power = power != 0;
+        state.versions.power++;
+    }
+
+    if (fields & capture_field_state) {
+        if (!get(&state.state, sizeof(state.state))) return false;
+        state.versions.state++;
+    }
+
+    if (fields & capture_field_ssid) {
+        if (!getString(state.ssid, sizeof(state.ssid))) return false;
+        state.versions.ssid++;
+    }
+
+    if (fields & capture_field_bssid) {
+        if (!getString(state.bssid, sizeof(state.bssid))) return false;
+        state.versions.bssid++;
+    }
+
+    if (fields & capture_field_platform) {
+        if (!get(&state.platform, sizeof(state.platform))) return false;
+        state.versions.platform++;
+    }
+
+    if (fields & capture_field_networks) {
+        uint16_t count;
+        if (!get(&count, sizeof(count)) || count > MAX_NETWORK_LIST_LENGTH) return false;
+        state.networks.count = count;
+        if (!get(state.networks.networks, sizeof(ioctl_network_info) * count)) return false;
+        state.versions.networks++;
+    }
+
+    if (fields & capture_field_station) {
+        if (!get(&state.station, sizeof(state.station))) return false;
+        state.versions.station++;
+    }
+
+    return at == size;
+}
+
+// Writes a capture as the refresher publishes snapshots. Only ever use it from one thread.
+class CaptureWriter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    ~CaptureWriter() {
+        stop();
+    }
+
+    // Returns false (and why, in error()) if the file couldn't be opened
+    bool start(const std::string& path) {
+        file = std::fopen(path.c_str(), "wb");
+
+        if (file == nullptr) {
+            problem = std::strerror(errno);
+            return false;
+        }
+
+        problem.clear();
+        epoch = clock::now();
+        lastFlush = epoch;
+        written = 0;
+        keyframes.clear();
+        buffer.clear();
+        writeCaptureHeader(buffer);
+        return flush();
+    }
+
+    // Writes the index, so readers don't have to go looking for keyframes themselves. Returns false (and why, in error()) if
+    // the end of the capture couldn't be written.
+    bool stop() {
+        if (file == nullptr) return true;
+
+        for (const capture_keyframe& keyframe : keyframes) {
+            put(&keyframe.time, sizeof(keyframe.time));
+            put(&keyframe.offset, sizeof(keyframe.offset));
+        }
+
+        uint64_t count = keyframes.size();
+        put(&lastTime, sizeof(lastTime));
+        put(&count, sizeof(count));
+        put(CAPTURE_INDEX_MAGIC, CAPTURE_MAGIC_LENGTH);
+        if (!flush()) return false;
+        bool closed = std::fclose(file) == 0;
+        file = nullptr;
+        if (!closed) problem = std::strerror(errno);
+        return closed;
+    }
+
+    bool active() const {
+        return file != nullptr;
+    }
+
+    // Why the capture couldn't be opened or written to, if it couldn't
+    const std::string& error() const {
+        return problem;
+    }
+
+    // Record whatever changed in 'state' since the last time (or everything, if it's time for a keyframe). Returns false if
+    // that's when writing failed (like a full disk); the capture's closed then, with everything up to the last good write.
+    bool write(const itlwm_state& state) {
+        if (file == nullptr) return true;
+        auto now = clock::now();
+        lastTime = std::chrono::duration_cast<std::chrono::microseconds>(now - epoch).count();
+        bool keyframe = keyframes.empty() || lastTime - keyframes.back().time >= CAPTURE_KEYFRAME_INTERVAL * 1000LL;
+        if (keyframe) keyframes.push_back({lastTime, written + buffer.size()});
+
+        encodeCaptureRecord(state, keyframe ? static_cast<uint8_t>(capture_field_all) : changedFields(last, state.versions), lastTime, buffer);
+        last = state.versions;
+        return now - lastFlush < std::chrono::milliseconds(CAPTURE_FLUSH_INTERVAL) || flush();
+    }
+
+private:
+    std::FILE* file = nullptr;
+    clock::time_point epoch;
+    clock::time_point lastFlush;
+    itlwm_versions last{};
+    int64_t lastTime = 0;
+    uint64_t written = 0; // Bytes already handed to the file
+    std::vector<capture_keyframe> keyframes; // One every CAPTURE_KEYFRAME_INTERVAL, so this stays tiny
+    std::vector<uint8_t> buffer; // Records that haven't been written out yet
+    std::string problem; // What error() returns
+
+    void put(const void* data, size_t size) {
+        buffer.insert(buffer.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+    }
+
+    // If this fails, nothing after it can go in the right place (keyframe offsets and all), so the capture's closed
+    bool flush() {
+        if ((!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) || std::fflush(file) != 0) {
+            problem = std::strerror(errno);
+            std::fclose(file);
+            file = nullptr;
+            buffer.clear();
+            return false;
+        }
+
+        written += buffer.size();
+        buffer.clear();
+        lastFlush = clock::now();
+        return true;
+    }
+};
+
+// A capture, memory-mapped. Nothing's read until it's asked for, and the OS pages it in and out as it likes, so a capture
+// that's hours long costs about as much memory as a short one. Once it's open, it's read-only, so any number of threads can
+// read from it at once.
+class CaptureFile {
+public:
+    CaptureFile() = default;
+    CaptureFile(const CaptureFile&) = delete;
+    CaptureFile& operator=(const CaptureFile&) = delete;
+
+    ~CaptureFile() {
+        close();
+    }
+
+    // Returns false if the file can't be opened or isn't a capture we understand
+    bool open(const std::string& path) {
+        close();
+        int descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) return false;
+
+        struct stat info;
+
+        if (fstat(descriptor, &info) != 0 || info.st_size < CAPTURE_HEADER_SIZE) {
+            ::close(descriptor);
+            return false;
+        }
+
+        void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        ::close(descriptor); // The mapping keeps the file around by itself
+
+        if (mapped == MAP_FAILED) return false;
+        data = static_cast<const uint8_t*>(mapped);
+        size = static_cast<size_t>(info.st_size);
+
+        if (readCaptureHeader(data, size) == 0) {
+            close();
+            return false;
+        }
+
+        if (!readIndex()) scan();
+        return true;
+    }
+
+    void close() {
+        if (data != nullptr) munmap(const_cast<uint8_t*>(data), size);
+        data = nullptr;
+        size = 0;
+        end = 0;
+        keyframes.clear();
+    }
+
+    bool isOpen() const { return data != nullptr; }
+    bool indexed() const { return hadIndex; } // If the index came from the file (instead of us walking the records for it)
+    const std::vector<capture_keyframe>& index() const { return keyframes; }
+    size_t first() const { return CAPTURE_HEADER_SIZE; } // Where the first record starts
+    size_t recordsEnd() const { return end; } // Where the last record ends
+
+    // When the first and last records were made
+    int64_t startTime() const { return keyframes.empty() ? 0 : keyframes.front().time; }
+    int64_t endTime() const { return lastTime; }
+
+    // The record starting at 'offset': everything after its length, and where the next one starts. False at the end (or
+    // if it's cut short).
+    bool record(size_t offset, const uint8_t*& record, size_t& length, size_t& next) const {
+        if (offset + sizeof(uint32_t) > end) return false;
+        uint32_t recordLength;
+        std::memcpy(&recordLength, data + offset, sizeof(recordLength));
+        if (recordLength > end - offset - sizeof(uint32_t)) return false;
+        record = data + offset + sizeof(uint32_t);
+        length = recordLength;
+        next = offset + sizeof(uint32_t) + recordLength;
+        return true;
+    }
+
+    // Puts 'state' the way it was at 'time' (every record up to and including it, starting from the keyframe before it), and
+    // returns where the first record after 'time' starts
+    size_t seek(int64_t time, itlwm_state& state) const {
+        std::memset(&state, 0, sizeof(state));
+        if (keyframes.empty()) return end;
+
+        auto after = std::upper_bound(keyframes.begin(), keyframes.end(), time, [](int64_t time, const capture_keyframe& keyframe) { return time < keyframe.time; });
+        size_t offset = after == keyframes.begin() ? keyframes.front().offset : std::prev(after)->offset;
+        bool first = true; // Always apply the keyframe, even if 'time' is before it
+        const uint8_t* record;
+        size_t length, next;
+
+        while (this->record(offset, record, length, next)) {
+            int64_t recordTime;
+            uint8_t fields;
+            if (!peekCaptureRecord(record, length, recordTime, fields) || (recordTime > time && !first)) break;
+            if (!decodeCaptureRecord(record, length, state)) return end;
+            offset = next;
+            first = false;
+        }
+
+        return offset;
+    }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t end = 0;
+    int64_t lastTime = 0;
+    bool hadIndex = false;
+    std::vector<capture_keyframe> keyframes;
+
+    bool readIndex() {
+        hadIndex = false;
+        if (size < CAPTURE_HEADER_SIZE + CAPTURE_INDEX_FOOTER_SIZE) return false;
+        const uint8_t* footer = data + size - CAPTURE_INDEX_FOOTER_SIZE;
+        if (std::memcmp(footer + 16, CAPTURE_INDEX_MAGIC, CAPTURE_MAGIC_LENGTH) != 0) return false;
+
+        uint64_t count;
+        std::memcpy(&lastTime, footer, sizeof(lastTime));
+        std::memcpy(&count, footer + 8, sizeof(count));
+        if (count > (size - CAPTURE_HEADER_SIZE - CAPTURE_INDEX_FOOTER_SIZE) / sizeof(capture_keyframe)) return false;
+
+        end = size - CAPTURE_INDEX_FOOTER_SIZE - count * sizeof(capture_keyframe);
+        keyframes.resize(count);
+        std::memcpy(keyframes.data(), data + end, count * sizeof(capture_keyframe));
+
+        for (const capture_keyframe& keyframe : keyframes) {
+            if (keyframe.offset < CAPTURE_HEADER_SIZE || keyframe.offset >= end) {
+                keyframes.clear();
+                return false;
+            }
+        }
+
+        hadIndex = true;
+        return true;
+    }
+
+    // No index, so walk every record once, keeping track of the ones that carry everything
+    void scan() {
+        keyframes.clear();
+        end = size;
+        lastTime = 0;
+        size_t offset = CAPTURE_HEADER_SIZE;
+        const uint8_t* record;
+        size_t length, next;
+
+        while (this->record(offset, record, length, next)) {
+            int64_t time;
+            uint8_t fields;
+            if (!peekCaptureRecord(record, length, time, fields)) break;
+            if (fields == capture_field_all) keyframes.push_back({time, offset});
+            lastTime = time;
+            offset = next;
+        }
+
+        end = offset; // Anything after this got cut off
+    }
+};
+
+#endif /* Capture_h */
@@ -0,0 +1,176 @@
+// ItlwmCLI CommandExecutor.h
+// Copyright 2026 by Calebh101
+//
+// Runs commands on their own thread, one at a time and in the order they were entered, so a driver call that takes a few seconds
+// (like connecting) doesn't freeze the UI. Whatever the command logs shows up as it happens, since log() is safe from any thread.
+// While something's running, the UI can ask what it is, how long it's been going and how far along it is, and the executor keeps
+// asking for redraws so that stays up to date.
+//
+// Cancelling drops everything that's queued and tells the running command to stop. Commands that loop (like 'run') check
+// cancelled() and stop early; a driver call that's already in progress can't be interrupted, so that one still finishes on its
+// own before the next command runs.
+
+#ifndef CommandExecutor_h
+#define CommandExecutor_h
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define EXECUTOR_TICK_INTERVAL 250 // How often (in milliseconds) we ask for a redraw while a command is running, so the elapsed time ticks
+
+struct executor_status {
+    bool busy; // If a command is running right now
+    std::string command; // What's running
+    std::chrono::milliseconds elapsed; // How long it's been running
+    double progress; // 0 to 1, or negative if the command doesn't know
+    size_t queued; // How many are waiting behind it
+    bool cancelling; // If we've asked it to stop and it hasn't yet
+};
+
+class CommandExecutor {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // 'run' runs one command (on the executor's thread), and 'changed' gets called whenever the status changes
+    CommandExecutor(std::function<void(const std::string&)> run, std::function<void()> changed) : run(std::move(run)), changed(std::move(changed)) {}
+
+    ~CommandExecutor() {
+        stop();
+    }
+
+    void start() {
+        stopping = false;
+        worker = std::thread([this] { work(); });
+        ticker = std::thread([this] { tick(); });
+    }
+
+    // Waits for whatever's running to finish; anything still queued is dropped
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            queue.clear();
+        }
+
+        cancelRequested = true;
+        signal.notify_all();
+        if (worker.joinable()) worker.join();
+        if (ticker.joinable()) ticker.join();
+    }
+
+    void submit(std::string command) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(command));
+        }
+
+        signal.notify_all();
+        changed();
+    }
+
+    // Drop everything queued and ask the running command to stop. Returns false if there was nothing to cancel.
+    bool cancel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!busy && queue.empty()) return false;
+            queue.clear();
+            if (busy) cancelRequested = true;
+        }
+
+        changed();
+        return true;
+    }
+
+    // For commands to check every so often (from the executor's thread)
+    bool cancelled() const {
+        return cancelRequested;
+    }
+
+    // For commands that know how far along they are (from the executor's thread)
+    void setProgress(double value) {
+        progress = value;
+    }
+
+    // If the calling thread is the executor's own (like a command that wants to know if it's running in the background)
+    bool onWorker() const {
+        return std::this_thread::get_id() == worker.get_id();
+    }
+
+    executor_status status() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        executor_status status{busy, current, std::chrono::milliseconds(0), progress, queue.size(), busy && cancelRequested};
+        if (busy) status.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - started);
+        return status;
+    }
+
+private:
+    std::function<void(const std::string&)> run;
+    std::function<void()> changed;
+    mutable std::mutex mutex;
+    std::condition_variable signal;
+    std::thread worker;
+    std::thread ticker;
+
+    std::deque<std::string> queue;
+    std::string current;
+    clock::time_point started;
+    bool busy = false;
+    bool stopping = false;
+    std::atomic<bool> cancelRequested{false};
+    std::atomic<double> progress{-1};
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            signal.wait(lock, [this] { return !queue.empty() || stopping; });
+            if (stopping) return;
+
+            current = std::move(queue.front());
+            queue.pop_front();
+            started = clock::now();
+            busy = true;
+            cancelRequested = false;
+            progress = -1;
+            std::string command = current;
+
+            lock.unlock();
+            signal.notify_all(); // Wake the ticker
+            changed();
+            run(command);
+            lock.lock();
+
+            busy = false;
+            current.clear();
+            lock.unlock();
+            changed();
+            lock.lock();
+        }
+    }
+
+    // Keeps the elapsed time moving on screen while something's running, and sleeps otherwise
+    void tick() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            signal.wait(lock, [this] { return busy || stopping; });
+            if (stopping) return;
+            signal.wait_for(lock, std::chrono::milliseconds(EXECUTOR_TICK_INTERVAL), [this] { return stopping; });
+            if (stopping) return;
+
+            if (busy) {
+                lock.unlock();
+                changed();
+                lock.lock();
+            }
+        }
+    }
+};
+
+#endif /* CommandExecutor_h */
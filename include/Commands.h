@@ -0,0 +1,149 @@
+// ItlwmCLI Commands.h
+// Copyright 2026 by Calebh101
+//
+// The table every command lives in. Each command says what it's called, how many arguments it takes, what it does, and how to
+// tab-complete it, and dispatching, 'help' and tab completion all come from that same table (so they can't disagree).
+// Commands can have their own table of subcommands, which works the same way one level down.
+
+#ifndef Commands_h
+#define Commands_h
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#define USAGE_COLUMN_WIDTH 42 // How wide the usage column of help output is
+
+class CommandRegistry;
+
+using command_args = std::vector<std::string>; // Everything the user typed, the command itself included
+using command_handler = std::function<void(const command_args& args)>;
+using completion_provider = std::function<std::vector<std::string>(const command_args& args)>; // Candidates for the argument being typed
+
+struct command_descriptor {
+    std::string name;
+    std::vector<std::string> aliases;
+    int minArgs = 0; // Not counting the command (or subcommand) itself
+    int maxArgs = 0; // -1 for no limit
+    std::string usage; // Like "connect [ssid] [password]"
+    std::string help; // What it does
+    command_handler handler{}; // Not needed if it has subcommands
+    completion_provider completer{}; // Optional
+    bool hidden = false; // Left out of help and completion
+    std::shared_ptr<CommandRegistry> subcommands{}; // Optional
+};
+
+enum dispatch_status {
+    dispatch_ok,
+    dispatch_not_found, // No such command
+    dispatch_bad_arity, // Wrong number of arguments
+    dispatch_missing_subcommand, // Command needs a subcommand and didn't get one
+    dispatch_bad_subcommand, // Command needs a subcommand and got one it doesn't know
+};
+
+struct dispatch_result {
+    dispatch_status status;
+    const command_descriptor* command; // The deepest command we found (if any)
+    std::string path; // Like "save password", for error messages
+};
+
+class CommandRegistry {
+public:
+    command_descriptor& add(command_descriptor descriptor) {
+        commands.push_back(std::make_unique<command_descriptor>(std::move(descriptor)));
+        command_descriptor& added = *commands.back();
+        lookup[added.name] = &added;
+        for (const std::string& alias : added.aliases) lookup[alias] = &added;
+        return added;
+    }
+
+    const command_descriptor* find(std::string_view name) const {
+        auto found = lookup.find(std::string(name));
+        return found == lookup.end() ? nullptr : found->second;
+    }
+
+    // Find and run the command in args[depth] (recursing into subcommands)
+    dispatch_result dispatch(const command_args& args, size_t depth = 0, std::string path = "") const {
+        if (depth >= args.size()) return {dispatch_not_found, nullptr, path};
+        const command_descriptor* command = find(args[depth]);
+        if (command == nullptr) return {dispatch_not_found, nullptr, path};
+        path = path.empty() ? command->name : path + " " + command->name;
+
+        if (command->subcommands) {
+            if (depth + 1 >= args.size()) return {dispatch_missing_subcommand, command, path};
+            dispatch_result result = command->subcommands->dispatch(args, depth + 1, path);
+            if (result.status == dispatch_not_found) return {dispatch_bad_subcommand, command, path};
+            return result;
+        }
+
+        int given = static_cast<int>(args.size() - depth - 1);
+        if (given < command->minArgs || (command->maxArgs >= 0 && given > command->maxArgs)) return {dispatch_bad_arity, command, path};
+        if (command->handler) command->handler(args);
+        return {dispatch_ok, command, path};
+    }
+
+    // One line per (visible) command, usage and description lined up
+    std::vector<std::string> helpLines() const {
+        std::vector<std::string> lines;
+
+        for (const auto& command : commands) {
+            if (!command->hidden) lines.push_back(helpLine(*command));
+        }
+
+        return lines;
+    }
+
+    // Usage and description of one command, lined up like helpLines()
+    static std::string helpLine(const command_descriptor& command) {
+        std::string usage = command.usage.empty() ? command.name : command.usage;
+        if (usage.size() < USAGE_COLUMN_WIDTH) usage.resize(USAGE_COLUMN_WIDTH, ' ');
+        else usage += " ";
+        return usage + command.help;
+    }
+
+    // Everything that could go in args.back(). 'depth' is which argument this registry's commands are.
+    std::vector<std::string> complete(const command_args& args, size_t depth = 0) const {
+        std::vector<std::string> candidates;
+        if (args.empty() || depth >= args.size()) return candidates;
+
+        if (depth + 1 == args.size()) { // Completing a command name
+            for (const auto& command : commands) {
+                if (!command->hidden && startsWith(command->name, args.back())) candidates.push_back(command->name);
+            }
+        } else {
+            const command_descriptor* command = find(args[depth]);
+            if (command == nullptr) return candidates;
+
+            if (command->subcommands) {
+                candidates = command->subcommands->complete(args, depth + 1);
+            } else if (command->completer) {
+                for (std::string& candidate : command->completer(args)) {
+                    if (startsWith(candidate, args.back())) candidates.push_back(std::move(candidate));
+                }
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        return candidates;
+    }
+
+    static std::string arityString(const command_descriptor& command) {
+        std::string count = command.maxArgs < 0 ? std::to_string(command.minArgs) + " or more" : (command.minArgs == command.maxArgs ? std::to_string(command.minArgs) : std::to_string(command.minArgs) + "-" + std::to_string(command.maxArgs));
+        return count + (command.minArgs == 1 && command.maxArgs == 1 ? " argument" : " arguments");
+    }
+
+private:
+    std::vector<std::unique_ptr<command_descriptor>> commands; // In the order they were added (which is the order help lists them in)
+    std::unordered_map<std::string, const command_descriptor*> lookup; // Names and aliases
+
+    static bool startsWith(const std::string& value, const std::string& prefix) {
+        return value.size() >= prefix.size() && value.compare(0, prefix.size(), prefix) == 0;
+    }
+};
+
+#endif /* Commands_h */
@@ -0,0 +1,580 @@
+// ItlwmCLI Daemon.h
+// Copyright 2026 by Calebh101
+//
+// Lets one ItlwmCLI (started with --daemon) do all the talking to itlwm and share what it sees over a Unix socket, so a TUI,
+// a headless stream and a few scripts don't each poll the driver on their own. Clients connect and send one line saying what
+// they want:
+//
+//     SUBSCRIBE binary        The capture format (see Capture.h): a header, a keyframe of where things stand right now, and
+//                             then a record of whatever changed every time a snapshot's published. This is what --attach uses.
+//     SUBSCRIBE json          The same lines --headless prints (see Headless.h), starting with one that has everything.
+//     CALL [call] [args...]   Make a driver call that changes something (power_on, power_off, connect_network, associate_ssid
+//                             or dis_associate_ssid, named like in 'perf'), with arguments quoted like on the command line.
+//                             The reply is one line, "OK [result]" or "ERR [reason]", and then the connection's closed.
+//
+// Record's ok flags say which parts of the snapshot the daemon actually got from itlwm (see packSnapshotFlags()); a part whose
+// flag is clear is unavailable, like the station info while we're not connected. JSON lines say the same thing with nulls.
+//
+// Anyone who can connect can read what we see and turn the WiFi off, and --attach sends passwords through the socket, so it's
+// only for us: it lives in a directory only we can get into (see defaultSocketPath()), it's made 0600, and both ends check
+// who's on the other side (our own user, or root) before saying anything.
+//
+// Subscribers all share the same records, so each snapshot's only encoded once no matter how many are listening. Everything
+// happens on one thread with poll(), except calls, which go to a thread of their own one at a time (like the command executor
+// does them), since connecting can take a while. A subscriber that falls too far behind is dropped instead of holding anyone up.
+
+#ifndef Daemon_h
+#define Daemon_h
+
+#include "Backend.h"
+#include "Capture.h"
+#include "Headless.h"
+#include "TimedBackend.h"
+#include "Tokenizer.h"
+#include <fmt/format.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#define DAEMON_SOCKET_NAME "ItlwmCLI.sock"    // What the socket's called, in defaultSocketPath()'s directory
+#define DAEMON_MAX_REQUEST 4096                 // Longest first line a client can send
+#define DAEMON_MAX_BACKLOG (4 * 1024 * 1024)    // Most bytes a subscriber can fall behind by before it's dropped
+#define DAEMON_RECONNECT_INTERVAL 1000          // Milliseconds between tries, when a subscriber loses the daemon
+
+#ifdef MSG_NOSIGNAL
+    #define DAEMON_SEND_FLAGS MSG_NOSIGNAL
+#else
+    #define DAEMON_SEND_FLAGS 0 // macOS doesn't have it, so sockets get SO_NOSIGPIPE instead
+#endif
+
+// So writing to a client that's gone fails instead of killing us with SIGPIPE (where MSG_NOSIGNAL doesn't exist)
+inline void ignoreSigpipe(int fd) {
+    #ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    #else
+        (void)fd;
+    #endif
+}
+
+// Where --daemon listens (and --attach connects) unless --socket says otherwise: somewhere only we can get into, so nobody
+// else can put a socket of their own there first. That's $XDG_RUNTIME_DIR where there is one, the per-user $TMPDIR on macOS,
+// and otherwise a directory of our own in /tmp (which SnapshotServer::start() makes, and checks is really ours).
+inline std::string defaultSocketPath() {
+    const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+    if (runtime != nullptr && runtime[0] == '/') return fmt::format("{}/{}", runtime, DAEMON_SOCKET_NAME);
+
+    #ifdef __APPLE__
+        const char* temporary = std::getenv("TMPDIR");
+
+        if (temporary != nullptr && temporary[0] == '/') {
+            std::string directory = temporary;
+            while (directory.size() > 1 && directory.back() == '/') directory.pop_back(); // It usually ends in one
+            return fmt::format("{}/{}", directory, DAEMON_SOCKET_NAME);
+        }
+    #endif
+
+    return fmt::format("/tmp/ItlwmCLI-{}/{}", getuid(), DAEMON_SOCKET_NAME);
+}
+
+// If whoever's on the other end of 'fd' is us (or root), so it's safe to tell them things (or believe what they tell us)
+inline bool trustedPeer(int fd) {
+    uid_t uid;
+
+    #ifdef SO_PEERCRED
+        ucred credentials;
+        socklen_t length = sizeof(credentials);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) return false;
+        uid = credentials.uid;
+    #else
+        gid_t gid;
+        if (getpeereid(fd, &uid, &gid) != 0) return false;
+    #endif
+
+    return uid == getuid() || uid == 0;
+}
+
+// Returns false if 'path' is too long for a socket
+inline bool socketAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Returns the connected socket, or -1 if nobody's listening at 'path'
+inline int connectDaemon(const std::string& path) {
+    sockaddr_un address;
+    if (!socketAddress(path, address)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    ignoreSigpipe(fd);
+
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// Blocking; returns false if the other end's gone
+inline bool sendAll(int fd, const void* data, size_t size) {
+    const char* at = static_cast<const char*>(data);
+
+    while (size > 0) {
+        ssize_t sent = send(fd, at, size, DAEMON_SEND_FLAGS);
+
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+
+        at += sent;
+        size -= sent;
+    }
+
+    return true;
+}
+
+// Quotes an argument for a CALL line, so the daemon's tokenizer gets it back exactly (spaces, quotes and all)
+inline std::string quoteArgument(std::string_view value) {
+    std::string result = "\"";
+
+    for (char c : value) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+
+    return result + '"';
+}
+
+class SnapshotServer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // Calls go to 'backend', and 'called' runs after each one (so the refresher can go see what changed)
+    SnapshotServer(Backend& backend, std::function<void()> called) : backend(backend), called(std::move(called)) {}
+
+    ~SnapshotServer() {
+        stop();
+    }
+
+    // Returns false (and why, in 'error') if we can't listen on 'path', like if another daemon already is
+    bool start(const std::string& path, std::string& error) {
+        sockaddr_un address;
+
+        if (!socketAddress(path, address)) {
+            error = "path is too long";
+            return false;
+        }
+
+        if (!checkDirectory(path, error)) return false;
+        int existing = connectDaemon(path);
+
+        if (existing >= 0) {
+            close(existing);
+            error = "another daemon is already listening there";
+            return false;
+        }
+
+        struct stat info;
+
+        if (lstat(path.c_str(), &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                error = "something that isn't a socket is already there";
+                return false;
+            }
+
+            unlink(path.c_str()); // Left behind by a daemon that didn't get to clean up
+        }
+
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        mode_t mask = umask(0177); // So the socket's 0600 from the moment it exists, instead of whatever the umask says
+        bool bound = listener >= 0 && bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+        umask(mask);
+
+        if (!bound || listen(listener, SOMAXCONN) != 0 || pipe(wake) != 0) {
+            error = std::strerror(errno);
+            closeAll();
+            return false;
+        }
+
+        setNonBlocking(listener);
+        setNonBlocking(wake[0]);
+        setNonBlocking(wake[1]);
+        this->path = path;
+        epoch = clock::now();
+        stopping = false;
+        worker = std::thread([this] { serve(); });
+        caller = std::thread([this] { call(); });
+        return true;
+    }
+
+    // Hangs up on everyone; a call that's in progress finishes first
+    void stop() {
+        if (!worker.joinable()) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        callSignal.notify_all();
+        poke();
+        worker.join();
+        caller.join();
+
+        for (Client& client : clients) close(client.fd);
+        for (pending_call& call : calls) close(call.fd);
+        clients.clear();
+        calls.clear();
+        closeAll();
+        unlink(path.c_str());
+    }
+
+    // Share a snapshot with every subscriber. Only ever call it from one thread (the refresher).
+    void publish(const itlwm_state& state) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            encodeCaptureRecord(state, published ? changedFields(last, state.versions) : static_cast<uint8_t>(capture_field_all), micros(), queued);
+            last = state.versions;
+            latest = state;
+            published = true;
+        }
+
+        poke();
+    }
+
+    // How many clients are subscribed right now
+    size_t subscribers() const {
+        return subscribed;
+    }
+
+private:
+    enum client_mode {
+        client_request, // Hasn't said what it wants yet
+        client_binary,
+        client_json,
+    };
+
+    struct Client {
+        int fd;
+        client_mode mode = client_request;
+        std::string request;
+        std::vector<uint8_t> out; // What we haven't managed to send it yet
+        size_t sent = 0; // How much of 'out' it already has
+        std::unique_ptr<HeadlessStream> json;
+        bool closed = false;
+    };
+
+    struct pending_call {
+        int fd;
+        std::vector<std::string> args;
+    };
+
+    Backend& backend;
+    std::function<void()> called;
+    std::string path;
+    clock::time_point epoch;
+    int listener = -1;
+    int wake[2] = {-1, -1}; // Written to whenever there's something for the server thread to do
+    std::thread worker;
+    std::thread caller;
+    std::atomic<size_t> subscribed{0};
+
+    std::mutex mutex; // Guards everything the refresher hands over, the call queue and 'stopping'
+    std::condition_variable callSignal;
+    bool stopping = false;
+    std::vector<uint8_t> queued; // Records published since the server thread last looked
+    itlwm_state latest{}; // What those records add up to
+    itlwm_versions last{};
+    bool published = false;
+    std::deque<pending_call> calls;
+
+    // Only the server thread touches these
+    std::vector<Client> clients;
+    std::vector<uint8_t> records;
+    itlwm_state state{}; // What every subscriber has been sent, so new ones can start from it
+    bool hasState = false;
+    std::vector<command_token> tokens;
+
+    int64_t micros() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - epoch).count();
+    }
+
+    // Makes sure the socket's directory is one only we (or root) can put things in, making it if it's not there
+    static bool checkDirectory(const std::string& path, std::string& error) {
+        size_t slash = path.find_last_of('/');
+        std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+        struct stat info;
+
+        if (lstat(directory.c_str(), &info) != 0) {
+            if (errno != ENOENT || mkdir(directory.c_str(), 0700) != 0 || lstat(directory.c_str(), &info) != 0) {
+                error = fmt::format("can't make {}: {}", directory, std::strerror(errno));
+                return false;
+            }
+        }
+
+        if (!S_ISDIR(info.st_mode) || (info.st_uid != getuid() && info.st_uid != 0)) {
+            error = fmt::format("{} isn't a directory that belongs to us", directory);
+            return false;
+        }
+
+        if ((info.st_mode & (S_IWGRP | S_IWOTH)) && !(info.st_mode & S_ISVTX)) { // Sticky ones (like /tmp) at least stop others swapping our socket out
+            error = fmt::format("{} can be written to by other users", directory);
+            return false;
+        }
+
+        return true;
+    }
+
+    static void setNonBlocking(int fd) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    void poke() {
+        char byte = 0;
+        [[maybe_unused]] ssize_t written = write(wake[1], &byte, 1); // If the pipe's full, the server's already got plenty to wake up for
+    }
+
+    void closeAll() {
+        if (listener >= 0) close(listener);
+        if (wake[0] >= 0) close(wake[0]);
+        if (wake[1] >= 0) close(wake[1]);
+        listener = wake[0] = wake[1] = -1;
+    }
+
+    void serve() {
+        std::vector<pollfd> fds;
+
+        while (true) {
+            fds.clear();
+            fds.push_back({wake[0], POLLIN, 0});
+            fds.push_back({listener, POLLIN, 0});
+            for (const Client& client : clients) fds.push_back({client.fd, static_cast<short>(POLLIN | (client.sent < client.out.size() ? POLLOUT : 0)), 0});
+            if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) return;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) return;
+            }
+
+            if (fds[0].revents & POLLIN) take();
+            for (size_t i = 0; i + 2 < fds.size(); i++) service(clients[i], fds[i + 2].revents);
+            if (fds[1].revents & POLLIN) accept();
+
+            size_t count = 0;
+
+            for (size_t i = 0; i < clients.size();) {
+                if (clients[i].closed) {
+                    if (clients[i].fd >= 0) close(clients[i].fd); // Calls take theirs with them
+                    clients[i] = std::move(clients.back());
+                    clients.pop_back();
+                } else {
+                    if (clients[i].mode != client_request) count++;
+                    i++;
+                }
+            }
+
+            subscribed = count;
+        }
+    }
+
+    // Pick up whatever the refresher published, and pass it on
+    void take() {
+        char drain[64];
+        while (read(wake[0], drain, sizeof(drain)) > 0) {}
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queued.empty()) return;
+            records.swap(queued);
+            state = latest;
+            hasState = true;
+        }
+
+        for (Client& client : clients) {
+            if (client.mode == client_binary) {
+                client.out.insert(client.out.end(), records.begin(), records.end());
+            } else if (client.mode == client_json) {
+                const std::string* line = client.json->next(state);
+                if (line != nullptr) client.out.insert(client.out.end(), line->begin(), line->end());
+            }
+
+            flush(client);
+        }
+
+        records.clear();
+    }
+
+    void accept() {
+        while (true) {
+            int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0) return;
+
+            if (!trustedPeer(fd)) { // Can't happen with the socket at 0600, unless someone changed that
+                close(fd);
+                continue;
+            }
+
+            setNonBlocking(fd);
+            ignoreSigpipe(fd);
+            Client client{};
+            client.fd = fd;
+            clients.push_back(std::move(client));
+        }
+    }
+
+    void service(Client& client, short events) {
+        if (client.closed) return; // Already gave up on it while passing records on
+        if (events & (POLLERR | POLLNVAL)) {
+            client.closed = true;
+            return;
+        }
+
+        if (events & (POLLIN | POLLHUP)) {
+            char buffer[1024];
+            ssize_t received = recv(client.fd, buffer, sizeof(buffer), 0);
+
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                client.closed = true;
+                return;
+            }
+
+            if (received > 0 && client.mode == client_request) { // Subscribers have nothing to say after that, so the rest is ignored
+                client.request.append(buffer, received);
+                size_t newline = client.request.find('\n');
+
+                if (newline != std::string::npos) {
+                    client.request.resize(newline);
+                    handle(client);
+                    if (client.closed) return;
+                } else if (client.request.size() > DAEMON_MAX_REQUEST) {
+                    reject(client, "request too long");
+                    return;
+                }
+            }
+        }
+
+        flush(client);
+    }
+
+    void handle(Client& client) {
+        std::vector<std::string> args;
+
+        if (splitArguments(client.request, tokens, args).status != tokenize_ok || args.empty()) {
+            reject(client, "couldn't understand that");
+        } else if (args[0] == "SUBSCRIBE" && args.size() == 2 && args[1] == "binary") {
+            client.mode = client_binary;
+            writeCaptureHeader(client.out);
+            if (hasState) encodeCaptureRecord(state, capture_field_all, micros(), client.out); // Where things stand, for the records after it to build on
+        } else if (args[0] == "SUBSCRIBE" && args.size() == 2 && args[1] == "json") {
+            client.mode = client_json;
+            client.json = std::make_unique<HeadlessStream>();
+            const std::string* line = hasState ? client.json->next(state) : nullptr;
+            if (line != nullptr) client.out.insert(client.out.end(), line->begin(), line->end());
+        } else if (args[0] == "CALL" && args.size() >= 2) {
+            fcntl(client.fd, F_SETFL, fcntl(client.fd, F_GETFL) & ~O_NONBLOCK); // The caller thread just waits on it
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                calls.push_back({client.fd, std::move(args)});
+            }
+
+            callSignal.notify_one();
+            client.fd = -1; // It's the caller thread's now
+            client.closed = true;
+        } else {
+            reject(client, "expected SUBSCRIBE binary, SUBSCRIBE json or CALL");
+        }
+
+        client.request.clear();
+        client.request.shrink_to_fit();
+    }
+
+    void reject(Client& client, const std::string& reason) {
+        std::string reply = fmt::format("ERR {}\n", reason);
+        send(client.fd, reply.data(), reply.size(), DAEMON_SEND_FLAGS); // Tiny, and it hasn't been sent anything else, so it fits
+        client.closed = true;
+    }
+
+    void flush(Client& client) {
+        while (client.sent < client.out.size()) {
+            ssize_t sent = send(client.fd, client.out.data() + client.sent, client.out.size() - client.sent, DAEMON_SEND_FLAGS);
+
+            if (sent > 0) {
+                client.sent += sent;
+            } else if (sent < 0 && errno == EINTR) {
+                continue;
+            } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                client.closed = true;
+                return;
+            }
+        }
+
+        if (client.sent == client.out.size()) {
+            client.out.clear();
+            client.sent = 0;
+        } else if (client.out.size() - client.sent > DAEMON_MAX_BACKLOG) { // It's not keeping up, and everyone else shouldn't pay for it
+            client.closed = true;
+        } else if (client.sent > client.out.size() / 2) {
+            client.out.erase(client.out.begin(), client.out.begin() + client.sent);
+            client.sent = 0;
+        }
+    }
+
+    // Makes calls as they come in, on the caller thread
+    void call() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            callSignal.wait(lock, [this] { return !calls.empty() || stopping; });
+            if (stopping) return;
+            pending_call next = std::move(calls.front());
+            calls.pop_front();
+
+            lock.unlock();
+            std::string reply = run(next.args);
+            sendAll(next.fd, reply.data(), reply.size());
+            close(next.fd);
+            if (called) called();
+            lock.lock();
+        }
+    }
+
+    std::string run(const std::vector<std::string>& args) {
+        const std::string& name = args[1];
+        size_t count = args.size() - 2;
+
+        if (name == backendCallToString(backend_call_power_on) && count == 0) return fmt::format("OK {}\n", backend.powerOn());
+        if (name == backendCallToString(backend_call_power_off) && count == 0) return fmt::format("OK {}\n", backend.powerOff());
+        if (name == backendCallToString(backend_call_connect_network) && count == 2) return fmt::format("OK {}\n", backend.connectNetwork(args[2].c_str(), args[3].c_str()) ? 1 : 0);
+        if (name == backendCallToString(backend_call_associate_ssid) && count == 2) return fmt::format("OK {}\n", backend.associateSsid(args[2].c_str(), args[3].c_str()));
+        if (name == backendCallToString(backend_call_disassociate_ssid) && count == 1) return fmt::format("OK {}\n", backend.disassociateSsid(args[2].c_str()));
+        return fmt::format("ERR no call named {} that takes {} argument{}\n", name, count, count == 1 ? "" : "s");
+    }
+};
+
+#endif /* Daemon_h */
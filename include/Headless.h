@@ -0,0 +1,287 @@
+// ItlwmCLI Headless.h
+// Copyright 2026 by Calebh101
+//
+// What --headless prints instead of drawing anything: one line of JSON every time something we report changes, for scripts
+// to read off of stdout. Each line has the state, SSID, RSSI and channel, plus what changed in the scan list since the line
+// before it (networks that showed up, went away, or changed RSSI), like:
+//
+//     {"ts":1760000000000,"power":true,"state":"run","ssid":"Home-001","rssi":-52,"channel":36,"scan":{"count":24,"added":[],"removed":[],"changed":[{"bssid":"02:1a:...","rssi":-61}]}}
+//
+// "scan" is only there when the scan list changed. Lines are built straight into a reused string (no JSON library, and no
+// allocating once it's warmed up), since this runs for every change for as long as we're running.
+
+#ifndef Headless_h
+#define Headless_h
+
+#include "Snapshot.h"
+#include "View.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#define HEADLESS_DEFAULT_RATE 10 // Most lines per second, by default; anything that changes in between is folded into the next one
+
+// Short names for the 802.11 states, for scripts (parse80211State() is for people)
+inline const char* stateName(uint32_t state) {
+    switch (state) {
+        case ITL80211_S_INIT: return "init";
+        case ITL80211_S_SCAN: return "scan";
+        case ITL80211_S_AUTH: return "auth";
+        case ITL80211_S_ASSOC: return "assoc";
+        case ITL80211_S_RUN: return "run";
+        default: return "unknown";
+    }
+}
+
+// How long the valid UTF-8 sequence starting at 'value' is, or 0 if it isn't one (overlong, a surrogate, past U+10FFFF, or
+// cut short)
+inline size_t utf8SequenceLength(const unsigned char* value, size_t length) {
+    unsigned char lead = value[0];
+    size_t size;
+    unsigned char low = 0x80, high = 0xbf; // What the second byte can be
+
+    if (lead >= 0xc2 && lead <= 0xdf) size = 2;
+    else if (lead >= 0xe0 && lead <= 0xef) size = 3;
+    else if (lead >= 0xf0 && lead <= 0xf4) size = 4;
+    else return 0;
+
+    if (lead == 0xe0) low = 0xa0; // Overlong
+    if (lead == 0xed) high = 0x9f; // Surrogates
+    if (lead == 0xf0) low = 0x90; // Overlong
+    if (lead == 0xf4) high = 0x8f; // Past U+10FFFF
+    if (length < size || value[1] < low || value[1] > high) return 0;
+
+    for (size_t i = 2; i < size; i++) {
+        if (value[i] < 0x80 || value[i] > 0xbf) return 0;
+    }
+
+    return size;
+}
+
+// 'value' as valid UTF-8, for places that need a string rather than JSON text (like nlohmann's keys): the same as what
+// appendJsonString() writes, so any byte that isn't part of valid UTF-8 becomes U+00XX (as if it were Latin-1)
+inline std::string toUtf8(const char* value, size_t length) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(value);
+    std::string out;
+    out.reserve(length);
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = bytes[i];
+
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+        } else if (size_t size = utf8SequenceLength(bytes + i, length - i)) {
+            out.append(value + i, size);
+            i += size - 1;
+        } else {
+            out += static_cast<char>(0xc0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3f));
+        }
+    }
+
+    return out;
+}
+
+inline std::string toUtf8(const std::string& value) {
+    return toUtf8(value.data(), value.size());
+}
+
+// SSIDs are just bytes, and plenty of them aren't UTF-8, so anything that isn't valid UTF-8 comes out as \u00XX (as if it
+// were Latin-1) instead of making the whole line invalid JSON
+inline void appendJsonString(std::string& out, const char* value, size_t length) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(value);
+    out += '"';
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = bytes[i];
+
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            fmt::format_to(std::back_inserter(out), "\\u{:04x}", c);
+        } else if (c < 0x80) {
+            out += static_cast<char>(c);
+        } else if (size_t size = utf8SequenceLength(bytes + i, length - i)) {
+            out.append(value + i, size);
+            i += size - 1;
+        } else {
+            fmt::format_to(std::back_inserter(out), "\\u{:04x}", c);
+        }
+    }
+
+    out += '"';
+}
+
+class HeadlessStream {
+public:
+    explicit HeadlessStream(std::FILE* out = nullptr) : out(out) {
+        line.reserve(4096);
+        previous.reserve(MAX_NETWORK_LIST_LENGTH);
+        current.reserve(MAX_NETWORK_LIST_LENGTH);
+    }
+
+    // Writes a line if anything we report changed since the last one. Returns false if the output's gone (like a closed pipe).
+    bool write(const itlwm_state& state) {
+        const std::string* line = next(state);
+        return line == nullptr || (std::fwrite(line->data(), 1, line->size(), out) == line->size() && std::fflush(out) == 0);
+    }
+
+    // The line for 'state' (newline and all), or nullptr if nothing we report changed since the last one. The line's only good
+    // until the next call.
+    const std::string* next(const itlwm_state& state) {
+        bool running = state.snapshot.power_ok && state.power && state.snapshot.state_ok && state.state == ITL80211_S_RUN;
+        bool stationOk = running && state.station.rssi < 0 && state.station.rssi > RSSI_UNAVAILABLE_THRESHOLD; // Same as the RSSI on screen
+        reported now;
+        now.power = state.snapshot.power_ok ? (state.power ? 1 : 0) : -1;
+        now.state = state.snapshot.state_ok ? static_cast<int64_t>(state.state) : -1;
+        now.rssi = stationOk ? state.station.rssi : 1; // 1 means unavailable (RSSI is never positive)
+        now.channel = stationOk ? static_cast<int64_t>(state.station.channel) : -1;
+        std::memset(now.ssid, 0, sizeof(now.ssid));
+        if (state.snapshot.ssid_ok && state.snapshot.power_ok && state.power) std::memcpy(now.ssid, state.ssid, MAX_SSID_LENGTH);
+
+        bool scanChanged = first || state.versions.networks != networksVersion || state.snapshot.networks_ok != networksOk;
+        if (scanChanged) collect(state);
+        bool scanDiffers = scanChanged && differs();
+        if (!first && !scanDiffers && std::memcmp(&now, &last, sizeof(reported)) == 0) return nullptr; // Nothing we'd report changed
+
+        line.clear();
+        int64_t ts = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        fmt::format_to(std::back_inserter(line), "{{\"ts\":{},\"power\":{}", ts, now.power < 0 ? "null" : (now.power ? "true" : "false"));
+        line += ",\"state\":";
+        if (now.state < 0) line += "null";
+        else appendJsonString(line, stateName(static_cast<uint32_t>(now.state)), std::strlen(stateName(static_cast<uint32_t>(now.state))));
+        line += ",\"ssid\":";
+        if (now.ssid[0] == 0) line += "null";
+        else appendJsonString(line, now.ssid, strnlen(now.ssid, MAX_SSID_LENGTH));
+        if (now.rssi > 0) line += ",\"rssi\":null,\"channel\":null";
+        else fmt::format_to(std::back_inserter(line), ",\"rssi\":{},\"channel\":{}", now.rssi, now.channel);
+        if (scanDiffers) writeScan();
+        line += "}\n";
+
+        std::memcpy(&last, &now, sizeof(reported));
+        first = false;
+
+        if (scanChanged) {
+            previous.swap(current);
+            networksVersion = state.versions.networks;
+            networksOk = state.snapshot.networks_ok;
+        }
+
+        return &line;
+    }
+
+private:
+    // Everything a line says, apart from the scan list
+    struct reported {
+        int64_t power; // -1 if unavailable
+        int64_t state; // -1 if unavailable
+        int64_t rssi; // 1 if unavailable
+        int64_t channel;
+        char ssid[MAX_SSID_LENGTH]; // Empty if unavailable
+    };
+
+    // A network, keyed by BSSID, since SSIDs aren't unique
+    struct network {
+        uint64_t bssid;
+        int16_t rssi;
+        uint32_t channel;
+        char ssid[MAX_SSID_LENGTH];
+    };
+
+    std::FILE* out;
+    std::string line;
+    bool first = true;
+    reported last{};
+    uint32_t networksVersion = 0;
+    bool networksOk = false;
+    std::vector<network> previous; // What the last line knew about, sorted by BSSID
+    std::vector<network> current;
+
+    void collect(const itlwm_state& state) {
+        current.clear();
+        if (!state.snapshot.networks_ok) return; // Nothing we can see, so everything's gone
+
+        for (int i = 0; i < std::min(state.networks.count, MAX_NETWORK_LIST_LENGTH); i++) {
+            const ioctl_network_info& info = state.networks.networks[i];
+            network entry;
+            entry.bssid = 0;
+            for (int j = 0; j < 6; j++) entry.bssid = entry.bssid << 8 | info.bssid[j];
+            entry.rssi = info.rssi;
+            entry.channel = info.channel;
+            std::memcpy(entry.ssid, info.ssid, MAX_SSID_LENGTH);
+            current.push_back(entry);
+        }
+
+        std::sort(current.begin(), current.end(), [](const network& a, const network& b) { return a.bssid < b.bssid; });
+    }
+
+    // If the line would have anything to say about the scan list
+    bool differs() const {
+        if (first || previous.size() != current.size()) return true;
+
+        for (size_t i = 0; i < current.size(); i++) {
+            if (previous[i].bssid != current[i].bssid || previous[i].rssi != current[i].rssi) return true;
+        }
+
+        return false;
+    }
+
+    void appendBssid(uint64_t bssid) {
+        fmt::format_to(std::back_inserter(line), "\"{:02x}:{:02x}:{:02x}:{:02x}:{:02x}:{:02x}\"", (bssid >> 40) & 0xFF, (bssid >> 32) & 0xFF, (bssid >> 24) & 0xFF, (bssid >> 16) & 0xFF, (bssid >> 8) & 0xFF, bssid & 0xFF);
+    }
+
+    // Walk both lists (they're sorted) at once, sorting out what's new, gone, and changed
+    void writeScan() {
+        fmt::format_to(std::back_inserter(line), ",\"scan\":{{\"count\":{}", current.size());
+
+        for (int pass = 0; pass < 3; pass++) {
+            line += pass == 0 ? ",\"added\":[" : (pass == 1 ? ",\"removed\":[" : ",\"changed\":[");
+            bool any = false;
+            size_t a = 0, b = 0;
+
+            while (a < previous.size() || b < current.size()) {
+                const network* entry = nullptr;
+
+                if (b < current.size() && (a >= previous.size() || current[b].bssid < previous[a].bssid)) {
+                    if (pass == 0) entry = &current[b];
+                    b++;
+                } else if (a < previous.size() && (b >= current.size() || previous[a].bssid < current[b].bssid)) {
+                    if (pass == 1) entry = &previous[a];
+                    a++;
+                } else {
+                    if (pass == 2 && previous[a].rssi != current[b].rssi) entry = &current[b];
+                    a++;
+                    b++;
+                }
+
+                if (entry == nullptr) continue;
+                if (any) line += ',';
+                any = true;
+                line += "{\"bssid\":";
+                appendBssid(entry->bssid);
+
+                if (pass != 2) {
+                    line += ",\"ssid\":";
+                    appendJsonString(line, entry->ssid, strnlen(entry->ssid, MAX_SSID_LENGTH));
+                }
+
+                if (pass != 1) fmt::format_to(std::back_inserter(line), ",\"rssi\":{}", entry->rssi);
+                if (pass == 0) fmt::format_to(std::back_inserter(line), ",\"channel\":{}", entry->channel);
+                line += '}';
+            }
+
+            line += ']';
+        }
+
+        line += '}';
+    }
+};
+
+#endif /* Headless_h */
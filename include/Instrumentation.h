@@ -0,0 +1,134 @@
+// ItlwmCLI Instrumentation.h
+// Copyright 2026 by Calebh101
+//
+// Cheap counters for the stats overlay: how long things take, how often they happen, and how long threads sit waiting on the
+// global mutex. Everything here is a handful of relaxed atomic adds, so it's always on, and showing the overlay just reads it.
+//
+// Times go into windows: whoever shows them takes the window (which starts a new one) every so often, and gets the count,
+// total and max since the last time it did.
+
+#ifndef Instrumentation_h
+#define Instrumentation_h
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// What a window looked like, in microseconds
+struct window_stat {
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+
+    double mean() const {
+        return count == 0 ? 0.0 : static_cast<double>(total) / count;
+    }
+};
+
+class WindowStat {
+public:
+    void record(uint64_t micros) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(micros, std::memory_order_relaxed);
+        uint64_t seen = largest.load(std::memory_order_relaxed);
+        while (micros > seen && !largest.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {}
+    }
+
+    // Everything since the last take(), and start a new window
+    window_stat take() {
+        return {count.exchange(0, std::memory_order_relaxed), total.exchange(0, std::memory_order_relaxed), largest.exchange(0, std::memory_order_relaxed)};
+    }
+
+private:
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> largest{0};
+};
+
+// Times a scope into a WindowStat
+class ScopedTimer {
+public:
+    explicit ScopedTimer(WindowStat& stat) : stat(stat), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        stat.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+private:
+    WindowStat& stat;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Who's taking the lock, so waits can be blamed on the right thing
+enum lock_site {
+    lock_site_renderer,
+    lock_site_refresher,
+    lock_site_log,
+    lock_site_other,
+    lock_site_count,
+};
+
+inline const char* lockSiteToString(int site) {
+    switch (site) {
+        case lock_site_renderer: return "renderer";
+        case lock_site_refresher: return "refresher";
+        case lock_site_log: return "log()";
+        default: return "other";
+    }
+}
+
+// A std::mutex that keeps track of how long each lock_site waited for it. Taking it when nobody else has it costs one try_lock
+// (same as a plain mutex); only when it's contended do we look at the clock.
+class InstrumentedMutex {
+public:
+    void lock() {
+        int site = currentSite();
+        acquisitions[site].fetch_add(1, std::memory_order_relaxed);
+        if (inner.try_lock()) return;
+
+        auto start = std::chrono::steady_clock::now();
+        inner.lock();
+        waits[site].record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    bool try_lock() {
+        return inner.try_lock();
+    }
+
+    void unlock() {
+        inner.unlock();
+    }
+
+    // How long 'site' waited (only the times it had to), since the last time someone asked
+    window_stat takeWaits(int site) {
+        return waits[site].take();
+    }
+
+    // How many times 'site' took the lock, since the last time someone asked
+    uint64_t takeAcquisitions(int site) {
+        return acquisitions[site].exchange(0, std::memory_order_relaxed);
+    }
+
+    // Mark everything this thread locks until the scope ends as coming from 'site'
+    class Site {
+    public:
+        explicit Site(lock_site site) : previous(currentSite()) { currentSite() = site; }
+        ~Site() { currentSite() = previous; }
+
+    private:
+        int previous;
+    };
+
+private:
+    std::mutex inner;
+    WindowStat waits[lock_site_count];
+    std::atomic<uint64_t> acquisitions[lock_site_count] = {};
+
+    static int& currentSite() {
+        thread_local int site = lock_site_other;
+        return site;
+    }
+};
+
+#endif /* Instrumentation_h */
@@ -0,0 +1,123 @@
+// ItlwmCLI LatencyHistogram.h
+// Copyright 2026 by Calebh101
+//
+// Counts how long something took, HDR histogram style: every power of two gets split into the same number of buckets, so a
+// bucket is never more than about 6% wide whether we're talking microseconds or seconds, and the whole thing is a fixed
+// array of counters. Recording is a couple of relaxed atomic adds, so any number of threads can do it without locking.
+
+#ifndef LatencyHistogram_h
+#define LatencyHistogram_h
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#define LATENCY_SUB_BITS 5      // Each power of two is split into 2^(this - 1) buckets (16), so percentiles are within about 6%
+#define LATENCY_MAX_BITS 36     // Anything longer than 2^36 microseconds (about 19 hours) counts as that
+#define LATENCY_BUCKETS (((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 2) << (LATENCY_SUB_BITS - 1)))
+
+// What a histogram looked like at some point, all in microseconds
+struct latency_summary {
+    uint64_t count;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t max;
+    double mean;
+};
+
+class LatencyHistogram {
+public:
+    void record(uint64_t micros) {
+        micros = std::min<uint64_t>(micros, (1ULL << LATENCY_MAX_BITS) - 1);
+        counts[indexFor(micros)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(micros, std::memory_order_relaxed);
+
+        uint64_t seen = largest.load(std::memory_order_relaxed);
+        while (micros > seen && !largest.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {}
+    }
+
+    // The smallest value that 'fraction' (0 to 1) of everything recorded is at or under, give or take a bucket
+    uint64_t percentile(double fraction) const {
+        uint64_t count = total.load(std::memory_order_relaxed);
+        if (count == 0) return 0;
+        uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * count)));
+        uint64_t seen = 0;
+
+        for (int i = 0; i < LATENCY_BUCKETS; i++) {
+            seen += counts[i].load(std::memory_order_relaxed);
+            if (seen >= target) return std::min(highestIn(i), largest.load(std::memory_order_relaxed));
+        }
+
+        return largest.load(std::memory_order_relaxed); // Recorded while we were counting
+    }
+
+    latency_summary summary() const {
+        uint64_t count = total.load(std::memory_order_relaxed);
+        return {count, percentile(0.5), percentile(0.9), percentile(0.99), largest.load(std::memory_order_relaxed), count == 0 ? 0.0 : static_cast<double>(sum.load(std::memory_order_relaxed)) / count};
+    }
+
+    // How many values were at most 'micros', for exporting fixed buckets. A bucket only counts once all of it is under, so
+    // this is off by a bucket's width at most.
+    uint64_t countAtMost(uint64_t micros) const {
+        uint64_t count = 0;
+
+        for (int i = 0; i < LATENCY_BUCKETS && highestIn(i) <= micros; i++) {
+            count += counts[i].load(std::memory_order_relaxed);
+        }
+
+        return count;
+    }
+
+    // Everything recorded, added up, in microseconds
+    uint64_t totalMicros() const {
+        return sum.load(std::memory_order_relaxed);
+    }
+
+    // Not atomic as a whole, so anything recorded at the same time might be half-counted
+    void reset() {
+        for (auto& bucket : counts) bucket.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        largest.store(0, std::memory_order_relaxed);
+    }
+
+    // Values below 2^LATENCY_SUB_BITS get a bucket each; after that, each power of two gets 2^(LATENCY_SUB_BITS - 1) of them
+    static int indexFor(uint64_t value) {
+        const uint64_t sub = 1ULL << LATENCY_SUB_BITS;
+        if (value < sub) return static_cast<int>(value);
+
+        int magnitude = 63 - countLeadingZeros(value) - (LATENCY_SUB_BITS - 1); // How far we shift to keep LATENCY_SUB_BITS bits
+        return static_cast<int>(magnitude * (sub / 2) + (value >> magnitude));
+    }
+
+    // The biggest value that lands in bucket 'index'
+    static uint64_t highestIn(int index) {
+        const uint64_t sub = 1ULL << LATENCY_SUB_BITS;
+        if (static_cast<uint64_t>(index) < sub) return index;
+
+        int magnitude = static_cast<int>(index / (sub / 2)) - 1;
+        uint64_t top = index - magnitude * (sub / 2);
+        return ((top + 1) << magnitude) - 1;
+    }
+
+private:
+    std::atomic<uint64_t> counts[LATENCY_BUCKETS] = {};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> largest{0};
+
+    static int countLeadingZeros(uint64_t value) {
+        #if defined(__GNUC__) || defined(__clang__)
+            return __builtin_clzll(value);
+        #else
+            int zeros = 0;
+            for (uint64_t bit = 1ULL << 63; bit != 0 && !(value & bit); bit >>= 1) zeros++;
+            return zeros;
+        #endif
+    }
+};
+
+#endif /* LatencyHistogram_h */
@@ -0,0 +1,213 @@
+// ItlwmCLI LogSink.h
+// Copyright 2026 by Calebh101
+//
+// Writes log lines to a file without the thread that logged them ever touching the disk. push() just drops the line (and when
+// it happened) into a fixed-size lock-free queue, and a background thread wakes up every so often, takes everything in the
+// queue, and writes it out in one go. If the file gets too big, it's renamed to 'file.1' (and 'file.1' to 'file.2', and so on)
+// and we start a new one. If the queue ever fills up because the disk can't keep up, lines are dropped (and we say how many).
+
+#ifndef LogSink_h
+#define LogSink_h
+
+#include "filesystem.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define LOG_SINK_QUEUE_SIZE 4096     // How many lines can be waiting to be written (must be a power of 2)
+#define LOG_SINK_FLUSH_INTERVAL 200  // How often (in milliseconds) the writer wakes up to write what's waiting
+#define LOG_SINK_ROTATIONS 3         // How many old files we keep around when rotating ('file.1' through 'file.3')
+
+class LogSink {
+public:
+    using clock = std::chrono::system_clock;
+
+    LogSink() : slots(new Slot[LOG_SINK_QUEUE_SIZE]) {
+        for (size_t i = 0; i < LOG_SINK_QUEUE_SIZE; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    ~LogSink() {
+        stop();
+    }
+
+    // Start writing to 'path' (appending if it's already there), rotating once it's over 'maxBytes' (0 to never rotate).
+    // Returns false if the file couldn't be opened.
+    bool start(const std::string& path, uint64_t maxBytes, bool timestamps = true) {
+        this->path = path;
+        this->maxBytes = maxBytes;
+        this->timestamps = timestamps;
+        file.open(path, std::ios::app | std::ios::binary);
+        if (!file.is_open()) return false;
+
+        std::error_code error;
+        written = ghc::filesystem::file_size(path, error);
+        if (error) written = 0;
+
+        stopping = false;
+        started = true;
+        worker = std::thread([this] { run(); });
+        return true;
+    }
+
+    // Writes whatever's still waiting before returning. Anything pushed after this starts is dropped, but anything that got
+    // in before it is written.
+    void stop() {
+        started = false;
+        while (pushing.load() != 0) std::this_thread::yield(); // Let pushes that already got past 'started' finish filling their slots
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        signal.notify_one();
+        if (worker.joinable()) worker.join();
+        if (file.is_open()) file.close();
+    }
+
+    bool active() const {
+        return started;
+    }
+
+    // Safe from any thread, never blocks, and never makes a syscall. Returns false if the line had to be dropped (or we're not
+    // started).
+    bool push(std::string line) {
+        pushing.fetch_add(1); // Before looking at 'started', so stop() either stops us here or waits for us (both seq_cst)
+
+        if (!started) {
+            pushing.fetch_sub(1);
+            return false;
+        }
+
+        size_t position = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true) {
+            slot = &slots[position & (LOG_SINK_QUEUE_SIZE - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (difference == 0) { // Free, if nobody beats us to it
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0) { // Full
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                pushing.fetch_sub(1);
+                return false;
+            } else { // Someone else took it; try the next one
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->time = clock::now(); // vDSO, so no syscall
+        slot->line = std::move(line);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        pushing.fetch_sub(1);
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0}; // Which lap this slot's on, and if it's been filled yet
+        clock::time_point time;
+        std::string line;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<size_t> tail{0}; // Where the next push goes (shared by every thread that logs)
+    alignas(64) size_t head = 0; // Where the next pop comes from (only the writer touches this)
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> started{false};
+    std::atomic<int> pushing{0}; // How many push()es are in progress
+
+    std::string path;
+    uint64_t maxBytes = 0;
+    bool timestamps = true;
+    std::ofstream file;
+    uint64_t written = 0; // How big the current file is
+    uint64_t reported = 0; // How many dropped lines we've already said something about
+
+    std::mutex mutex;
+    std::condition_variable signal;
+    std::thread worker;
+    bool stopping = false;
+
+    void run() {
+        std::string batch;
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            signal.wait_for(lock, std::chrono::milliseconds(LOG_SINK_FLUSH_INTERVAL), [this] { return stopping; });
+            bool last = stopping;
+            lock.unlock();
+            drain(batch);
+            lock.lock();
+            if (last) return;
+        }
+    }
+
+    // Take everything waiting and write it out in one go
+    void drain(std::string& batch) {
+        batch.clear();
+
+        while (true) {
+            Slot& slot = slots[head & (LOG_SINK_QUEUE_SIZE - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != head + 1) break; // Nothing more (yet)
+            if (timestamps) batch += formatTime(slot.time);
+            batch += slot.line;
+            batch += '\n';
+            slot.line.clear();
+            slot.sequence.store(head + LOG_SINK_QUEUE_SIZE, std::memory_order_release); // Free for the next lap
+            head++;
+        }
+
+        uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+
+        if (droppedNow != reported) {
+            batch += (timestamps ? formatTime(clock::now()) : "") + "(" + std::to_string(droppedNow - reported) + " lines dropped; the log file couldn't keep up)\n";
+            reported = droppedNow;
+        }
+
+        if (batch.empty() || !file.is_open()) return;
+        file.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+        file.flush();
+        written += batch.size();
+        if (maxBytes > 0 && written >= maxBytes) rotate();
+    }
+
+    // file -> file.1 -> file.2 and so on, dropping the oldest
+    void rotate() {
+        file.close();
+        std::error_code error;
+        ghc::filesystem::remove(path + "." + std::to_string(LOG_SINK_ROTATIONS), error);
+
+        for (int i = LOG_SINK_ROTATIONS - 1; i >= 1; i--) {
+            ghc::filesystem::rename(path + "." + std::to_string(i), path + "." + std::to_string(i + 1), error);
+        }
+
+        ghc::filesystem::rename(path, path + ".1", error);
+        file.open(path, std::ios::trunc | std::ios::binary);
+        written = 0;
+    }
+
+    static std::string formatTime(clock::time_point time) {
+        std::time_t seconds = clock::to_time_t(time);
+        int millis = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+
+        char buffer[40];
+        size_t length = std::strftime(buffer, sizeof(buffer), "[%Y-%m-%d %H:%M:%S", &local);
+        std::snprintf(buffer + length, sizeof(buffer) - length, ".%03d] ", millis);
+        return buffer;
+    }
+};
+
+#endif /* LogSink_h */
@@ -0,0 +1,103 @@
+// ItlwmCLI LogStore.h
+// Copyright 2026 by Calebh101
+//
+// Where the command line's logs live. Lines go into fixed-size chunks, and once we're holding more than the limit, the oldest
+// chunk is dropped all at once (or handed to a spill function first, if there is one). Readers copy out just the lines they're
+// about to show, so a frame costs the same whether we've logged ten lines or ten million.
+//
+// Line numbers count every line ever logged, so they stay the same even after older lines are dropped.
+
+#ifndef LogStore_h
+#define LogStore_h
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define LOG_CHUNK_LINES 256 // How many lines go in a chunk (and how many get dropped at once)
+
+class LogStore {
+public:
+    explicit LogStore(size_t maxLines, size_t chunkLines = LOG_CHUNK_LINES) : chunkLines(chunkLines > 0 ? chunkLines : 1), maxLines(maxLines > this->chunkLines ? maxLines : this->chunkLines) {}
+
+    // Hand dropped lines to this instead of forgetting them (like to write them to a file). Set it before anything's logged.
+    void spillTo(std::function<void(std::vector<std::string>&&)> spill) {
+        this->spill = std::move(spill);
+    }
+
+    void append(std::string line) {
+        std::vector<std::string> evicted;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (chunks.empty() || chunks.back().size() >= chunkLines) {
+                chunks.emplace_back();
+                chunks.back().reserve(chunkLines);
+            }
+
+            chunks.back().push_back(std::move(line));
+            retained++;
+            appended++;
+
+            if (retained > maxLines) { // Over the limit, so the oldest chunk goes
+                evicted = std::move(chunks.front());
+                chunks.pop_front();
+                retained -= evicted.size();
+            }
+        }
+
+        if (!evicted.empty() && spill) spill(std::move(evicted)); // Outside the lock, so readers never wait on it
+    }
+
+    // How many lines have ever been logged
+    uint64_t total() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return appended;
+    }
+
+    // How many lines we're still holding
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return retained;
+    }
+
+    // Copy out up to 'count' lines, ending 'fromBottom' lines above the newest one (clamped to what we still have), oldest first.
+    // Returns the line number (counting from 0, like total()) of the first line copied.
+    uint64_t window(size_t fromBottom, size_t count, std::vector<std::string>& out) const {
+        out.clear();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (retained == 0) return appended;
+
+        size_t end = retained > fromBottom ? retained - fromBottom : 0; // One past the last line we want, counting from the oldest we have
+        size_t begin = end > count ? end - count : 0;
+        size_t chunk = 0;
+        size_t offset = begin;
+
+        while (chunk < chunks.size() && offset >= chunks[chunk].size()) offset -= chunks[chunk++].size();
+
+        for (size_t i = begin; i < end && chunk < chunks.size(); i++) {
+            out.push_back(chunks[chunk][offset]);
+            if (++offset >= chunks[chunk].size()) {
+                chunk++;
+                offset = 0;
+            }
+        }
+
+        return appended - retained + begin;
+    }
+
+private:
+    size_t chunkLines;
+    size_t maxLines;
+    mutable std::mutex mutex;
+    std::deque<std::vector<std::string>> chunks;
+    size_t retained = 0;
+    uint64_t appended = 0;
+    std::function<void(std::vector<std::string>&&)> spill;
+};
+
+#endif /* LogStore_h */
@@ -0,0 +1,321 @@
+// ItlwmCLI Metrics.h
+// Copyright 2026 by Calebh101
+//
+// Exports what we know about itlwm for Prometheus (with --metrics-file or --metrics-port): RSSI, noise, channel, PHY mode,
+// the 802.11 state, how big the scan list is, and how long every driver call has been taking. It's OpenMetrics text, but
+// only with types the older Prometheus text parser knows too (gauges and histograms), so node_exporter's textfile collector
+// can read the file just as well as Prometheus can scrape the port.
+//
+// Everything happens on the exporter's own thread, which reads the newest published snapshot (never waiting on the refresher)
+// and the latency histograms. The file's written to a temporary file and renamed over the real one, so the collector never
+// sees half of it, and no more often than every --metrics-interval seconds. Scrapes get metrics rendered at most once a second.
+
+#ifndef Metrics_h
+#define Metrics_h
+
+#include "Daemon.h"
+#include "Headless.h"
+#include "Snapshot.h"
+#include "TimedBackend.h"
+#include <fmt/format.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#define METRICS_DEFAULT_INTERVAL 15   // Seconds between writes of the metrics file, by default
+#define METRICS_RENDER_INTERVAL 1000  // Most often (in milliseconds) metrics get rendered again for a scrape
+#define METRICS_MAX_REQUEST 8192      // Most we'll read of a scrape's request
+#define METRICS_REQUEST_TIMEOUT 1000  // Milliseconds a scraper gets for the whole scrape, so a slow one can't hold up the file
+
+// Upper bounds of the latency histogram buckets, in microseconds
+inline constexpr uint64_t metricsLatencyBuckets[] = {100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000};
+
+// Short names for PHY modes, for labels (itlPhyModeToString() is for people)
+inline const char* phyModeName(itl_phy_mode mode) {
+    switch (mode) {
+        case ITL80211_MODE_11A: return "11a";
+        case ITL80211_MODE_11B: return "11b";
+        case ITL80211_MODE_11G: return "11g";
+        case ITL80211_MODE_11N: return "11n";
+        case ITL80211_MODE_11AC: return "11ac";
+        case ITL80211_MODE_11AX: return "11ax";
+        default: return "unknown";
+    }
+}
+
+// Prometheus throws out the whole scrape (and node_exporter the whole file) over one label value that isn't valid UTF-8, so
+// SSIDs go through toUtf8() first, the same way they do for JSON
+inline void appendLabelValue(std::string& out, const char* value, size_t length) {
+    std::string valid = toUtf8(value, length);
+    out += '"';
+
+    for (char c : valid) {
+        if (c == '\n') {
+            out += "\\n";
+        } else {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+    }
+
+    out += '"';
+}
+
+// Renders everything into 'out' (which is cleared first)
+inline void renderMetrics(const itlwm_state& state, bool published, const BackendLatency& latency, std::string& out) {
+    auto put = std::back_inserter(out);
+    out.clear();
+
+    bool on = published && state.snapshot.power_ok && state.power;
+    bool running = on && state.snapshot.state_ok && state.state == ITL80211_S_RUN;
+    bool station = running && state.snapshot.station_ok && state.station.rssi < 0 && state.station.rssi > RSSI_UNAVAILABLE_THRESHOLD; // Same as the RSSI on screen
+
+    out += "# TYPE itlwm_up gauge\n# HELP itlwm_up Whether itlwm has told us anything yet.\n";
+    fmt::format_to(put, "itlwm_up {}\n", published && state.snapshot.power_ok ? 1 : 0);
+    out += "# TYPE itlwm_power_on gauge\n# HELP itlwm_power_on Whether the WiFi is on.\n";
+    fmt::format_to(put, "itlwm_power_on {}\n", on ? 1 : 0);
+
+    out += "# TYPE itlwm_state gauge\n# HELP itlwm_state The 802.11 state; the current one is 1.\n";
+    for (uint32_t value : {ITL80211_S_INIT, ITL80211_S_SCAN, ITL80211_S_AUTH, ITL80211_S_ASSOC, ITL80211_S_RUN}) {
+        fmt::format_to(put, "itlwm_state{{state=\"{}\"}} {}\n", stateName(value), on && state.snapshot.state_ok && state.state == value ? 1 : 0);
+    }
+
+    if (station) { // Everything about our connection's missing while we're not connected, instead of being some made-up number
+        out += "# TYPE itlwm_rssi_dbm gauge\n# HELP itlwm_rssi_dbm Signal strength of the network we're connected to.\n";
+        fmt::format_to(put, "itlwm_rssi_dbm {}\n", state.station.rssi);
+        out += "# TYPE itlwm_noise_dbm gauge\n# HELP itlwm_noise_dbm Noise on the network we're connected to.\n";
+        fmt::format_to(put, "itlwm_noise_dbm {}\n", state.station.noise);
+        out += "# TYPE itlwm_channel gauge\n# HELP itlwm_channel Channel of the network we're connected to.\n";
+        fmt::format_to(put, "itlwm_channel {}\n", state.station.channel);
+        out += "# TYPE itlwm_phy_mode gauge\n# HELP itlwm_phy_mode PHY mode of our connection (always 1; the mode's in the label).\n";
+        fmt::format_to(put, "itlwm_phy_mode{{mode=\"{}\"}} 1\n", phyModeName(state.station.op_mode));
+
+        if (state.snapshot.ssid_ok) {
+            out += "# TYPE itlwm_connected_network gauge\n# HELP itlwm_connected_network The network we're connected to (always 1; the SSID's in the label).\nitlwm_connected_network{ssid=";
+            appendLabelValue(out, state.ssid, strnlen(state.ssid, MAX_SSID_LENGTH));
+            out += "} 1\n";
+        }
+    }
+
+    if (on && state.snapshot.networks_ok) {
+        out += "# TYPE itlwm_scan_networks gauge\n# HELP itlwm_scan_networks How many networks the last scan found.\n";
+        fmt::format_to(put, "itlwm_scan_networks {}\n", state.networks.count);
+    }
+
+    out += "# TYPE itlwm_backend_call_duration_seconds histogram\n# HELP itlwm_backend_call_duration_seconds How long driver calls take.\n";
+
+    for (int call = 0; call < backend_call_count; call++) {
+        const LatencyHistogram& histogram = latency[call];
+        const char* name = backendCallToString(call);
+
+        for (uint64_t bound : metricsLatencyBuckets) {
+            fmt::format_to(put, "itlwm_backend_call_duration_seconds_bucket{{call=\"{}\",le=\"{}\"}} {}\n", name, bound / 1e6, histogram.countAtMost(bound));
+        }
+
+        uint64_t count = histogram.countAtMost(UINT64_MAX); // Last, so it's never less than a bucket recorded into while we were counting
+        fmt::format_to(put, "itlwm_backend_call_duration_seconds_bucket{{call=\"{}\",le=\"+Inf\"}} {}\n", name, count);
+        fmt::format_to(put, "itlwm_backend_call_duration_seconds_count{{call=\"{}\"}} {}\n", name, count);
+        fmt::format_to(put, "itlwm_backend_call_duration_seconds_sum{{call=\"{}\"}} {}\n", name, histogram.totalMicros() / 1e6);
+    }
+
+    out += "# EOF\n";
+}
+
+class MetricsExporter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // 'read' fills in the newest snapshot, and returns false if there hasn't been one yet
+    MetricsExporter(std::function<bool(itlwm_state&)> read, const BackendLatency& latency) : read(std::move(read)), latency(latency) {}
+
+    ~MetricsExporter() {
+        stop();
+    }
+
+    // Writes 'path' (if it's not empty) every 'interval' seconds, and serves scrapes on 127.0.0.1:'port' (if it's not 0).
+    // Returns false (and which step failed, and why, in 'error') if it can't.
+    bool start(const std::string& path, int interval, int port, std::string& error) {
+        this->path = path;
+        this->interval = std::chrono::seconds(std::max(1, interval));
+
+        if (pipe(wake) != 0) {
+            error = fmt::format("can't make a pipe: {}", std::strerror(errno));
+            return false;
+        }
+
+        if (port != 0) {
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(port));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Only for this machine; anything further away can go through node_exporter
+            int on = 1;
+            const char* failed = nullptr; // Which step
+            listener = socket(AF_INET, SOCK_STREAM, 0);
+
+            if (listener < 0) {
+                failed = "make a socket for";
+            } else if (setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0) {
+                failed = "set up a socket for";
+            } else if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                failed = "bind to";
+            } else if (listen(listener, 16) != 0) {
+                failed = "listen on";
+            }
+
+            if (failed != nullptr) {
+                error = fmt::format("can't {} 127.0.0.1:{}: {}", failed, port, std::strerror(errno));
+                closeAll();
+                return false;
+            }
+        }
+
+        worker = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        if (!worker.joinable()) return;
+        char byte = 0;
+        [[maybe_unused]] ssize_t written = write(wake[1], &byte, 1);
+        worker.join();
+        closeAll();
+    }
+
+private:
+    std::function<bool(itlwm_state&)> read;
+    const BackendLatency& latency;
+    std::string path;
+    clock::duration interval;
+    int listener = -1;
+    int wake[2] = {-1, -1}; // Written to when it's time to stop
+    std::thread worker;
+
+    itlwm_state state{};
+    std::string text; // The last thing we rendered
+    clock::time_point rendered;
+    bool hasRendered = false;
+
+    void closeAll() {
+        if (listener >= 0) close(listener);
+        if (wake[0] >= 0) close(wake[0]);
+        if (wake[1] >= 0) close(wake[1]);
+        listener = wake[0] = wake[1] = -1;
+    }
+
+    void render() {
+        auto now = clock::now();
+        if (hasRendered && now - rendered < std::chrono::milliseconds(METRICS_RENDER_INTERVAL)) return; // Still fresh enough
+        renderMetrics(state, read(state), latency, text);
+        rendered = now;
+        hasRendered = true;
+    }
+
+    void run() {
+        auto next = clock::now();
+
+        while (true) {
+            int timeout = -1;
+            if (!path.empty()) timeout = static_cast<int>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(next - clock::now()).count()));
+
+            pollfd fds[2] = {{wake[0], POLLIN, 0}, {listener, POLLIN, 0}};
+            if (poll(fds, listener >= 0 ? 2 : 1, timeout) < 0 && errno != EINTR) return;
+            if (fds[0].revents & POLLIN) return;
+
+            if (!path.empty() && clock::now() >= next) {
+                writeFile();
+                next = clock::now() + interval;
+            }
+
+            if (listener >= 0 && (fds[1].revents & POLLIN)) {
+                int fd = accept(listener, nullptr, nullptr);
+
+                if (fd >= 0) {
+                    ignoreSigpipe(fd);
+                    serve(fd);
+                }
+            }
+        }
+    }
+
+    void writeFile() {
+        render();
+        std::string temporary = path + ".tmp"; // Next to it, so the rename's atomic (and the textfile collector only reads *.prom)
+        std::FILE* file = std::fopen(temporary.c_str(), "wb");
+        if (file == nullptr) return;
+        bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+        written = std::fclose(file) == 0 && written;
+        if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) std::remove(temporary.c_str());
+    }
+
+    // Waits for 'fd' to be ready for 'events', until 'deadline' at the latest. Returns false if it never was.
+    static bool waitFor(int fd, short events, clock::time_point deadline) {
+        while (true) {
+            int64_t remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock::now()).count();
+            if (remaining <= 0) return false;
+            pollfd entry = {fd, events, 0};
+            int ready = poll(&entry, 1, static_cast<int>(remaining));
+            if (ready < 0 && errno == EINTR) continue;
+            return ready > 0;
+        }
+    }
+
+    // Answers one scrape, then hangs up. The whole thing gets METRICS_REQUEST_TIMEOUT, however slowly the scraper sends (or
+    // reads), since the file doesn't get written while we're in here.
+    void serve(int fd) {
+        auto deadline = clock::now() + std::chrono::milliseconds(METRICS_REQUEST_TIMEOUT);
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        std::string request;
+        char chunk[1024];
+
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < METRICS_MAX_REQUEST) {
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+
+            if (received < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (errno != EINTR && !waitFor(fd, POLLIN, deadline)) break;
+                continue;
+            }
+
+            if (received <= 0) break;
+            request.append(chunk, received);
+        }
+
+        std::string response;
+
+        if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 14, "GET /metrics?") == 0 || request.compare(0, 6, "GET / ") == 0) {
+            render();
+            response = fmt::format("HTTP/1.1 200 OK\r\nContent-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\nContent-Length: {}\r\nConnection: close\r\n\r\n", text.size()) + text;
+        } else {
+            response = "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 24\r\nConnection: close\r\n\r\nMetrics are at /metrics\n";
+        }
+
+        size_t at = 0;
+
+        while (at < response.size()) {
+            ssize_t sent = send(fd, response.data() + at, response.size() - at, DAEMON_SEND_FLAGS);
+
+            if (sent < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (errno != EINTR && !waitFor(fd, POLLOUT, deadline)) break;
+                continue;
+            }
+
+            if (sent < 0) break;
+            at += sent;
+        }
+
+        close(fd);
+    }
+};
+
+#endif /* Metrics_h */
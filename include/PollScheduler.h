@@ -0,0 +1,144 @@
+// ItlwmCLI PollScheduler.h
+// Copyright 2026 by Calebh101
+//
+// Decides when each thing we ask itlwm for is due to be asked again. The RSSI changes constantly, the scan list every few
+// seconds, and the platform info never (until the card's powered back on), so there's no reason to ask for all of them at once.
+// Everything speeds up while we're connecting (so the UI keeps up with the state changes) and slows way down when idle or off.
+
+#ifndef PollScheduler_h
+#define PollScheduler_h
+
+#include "Api.h"
+#include <algorithm>
+#include <chrono>
+
+enum poll_source {
+    poll_source_power,
+    poll_source_state,
+    poll_source_ssid,
+    poll_source_bssid,
+    poll_source_platform,
+    poll_source_networks,
+    poll_source_station,
+    poll_source_count,
+};
+
+enum poll_mode {
+    poll_mode_off,        // WiFi is off; only watch for it coming back on
+    poll_mode_idle,       // On, but not connected to anything
+    poll_mode_connected,  // Connected and running
+    poll_mode_transition, // Scanning, authenticating or associating
+};
+
+#define POLL_NEVER 0 // Interval meaning "don't poll this in this mode"
+#define POLL_ONCE -1 // Interval meaning "poll this once per power cycle"
+#define POLL_RETRY_INTERVAL 1000 // How long to wait before retrying a POLL_ONCE source that failed
+
+class PollScheduler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    PollScheduler() {
+        wake();
+    }
+
+    // How often (in milliseconds) a source is polled in a given mode
+    static int interval(poll_source source, poll_mode mode) {
+        static const int intervals[poll_source_count][4] = {
+            //  off          idle         connected    transition
+            {1000,        1000,        1000,        250},          // power
+            {POLL_NEVER,  500,         500,         50},           // 802.11 state
+            {POLL_NEVER,  2000,        1000,        100},          // SSID
+            {POLL_NEVER,  2000,        2000,        250},          // BSSID
+            {POLL_NEVER,  POLL_ONCE,   POLL_ONCE,   POLL_ONCE},    // platform info
+            {POLL_NEVER,  2000,        3000,        1000},         // scan list
+            {POLL_NEVER,  1000,        250,         100},          // station info (RSSI)
+        };
+
+        return intervals[source][mode];
+    }
+
+    static poll_mode modeFor(bool powerOk, bool power, bool stateOk, uint32_t state) {
+        if (powerOk && !power) return poll_mode_off;
+        if (!stateOk) return poll_mode_idle;
+        if (state == ITL80211_S_RUN) return poll_mode_connected;
+        if (state == ITL80211_S_SCAN || state == ITL80211_S_AUTH || state == ITL80211_S_ASSOC) return poll_mode_transition;
+        return poll_mode_idle;
+    }
+
+    poll_mode currentMode() const {
+        return mode;
+    }
+
+    bool due(poll_source source, clock::time_point now) const {
+        return active[source] && nextPoll[source] <= now;
+    }
+
+    // Tell the scheduler we just polled something, so it knows when to do it again
+    void polled(poll_source source, clock::time_point now, bool ok) {
+        lastPoll[source] = now;
+        int ms = interval(source, mode);
+
+        if (ms == POLL_ONCE) {
+            active[source] = !ok; // Got it, so we're done until the next power cycle
+            nextPoll[source] = now + std::chrono::milliseconds(POLL_RETRY_INTERVAL);
+        } else {
+            active[source] = ms != POLL_NEVER;
+            nextPoll[source] = now + std::chrono::milliseconds(std::max(ms, 0));
+        }
+    }
+
+    // Switch cadences. Anything that should now be polled sooner gets pulled in; anything slower just waits out its new interval.
+    void setMode(poll_mode mode, clock::time_point now) {
+        if (mode == this->mode) return;
+        poll_mode previous = this->mode;
+        this->mode = mode;
+
+        for (int i = 0; i < poll_source_count; i++) {
+            int ms = interval(static_cast<poll_source>(i), mode);
+
+            if (ms == POLL_NEVER) {
+                active[i] = false;
+            } else if (ms == POLL_ONCE) {
+                if (interval(static_cast<poll_source>(i), previous) == POLL_NEVER) { // Coming back from off counts as a new power cycle
+                    active[i] = true;
+                    nextPoll[i] = now;
+                }
+            } else if (!active[i]) {
+                active[i] = true;
+                nextPoll[i] = now;
+            } else {
+                nextPoll[i] = std::min(nextPoll[i], lastPoll[i] + std::chrono::milliseconds(ms));
+            }
+        }
+    }
+
+    // Make everything due right now (like after a command that changes itlwm's state)
+    void wake() {
+        clock::time_point now = clock::now();
+
+        for (int i = 0; i < poll_source_count; i++) {
+            active[i] = true;
+            nextPoll[i] = now;
+        }
+    }
+
+    // When the next source is due, or a long way off if nothing is
+    clock::time_point nextDue() const {
+        clock::time_point next = clock::time_point::max();
+
+        for (int i = 0; i < poll_source_count; i++) {
+            if (active[i]) next = std::min(next, nextPoll[i]);
+        }
+
+        return next;
+    }
+
+private:
+    poll_mode mode = poll_mode_idle;
+    bool active[poll_source_count] = {};
+    clock::time_point nextPoll[poll_source_count] = {};
+    clock::time_point lastPoll[poll_source_count] = {};
+};
+
+#endif /* PollScheduler_h */
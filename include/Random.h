@@ -0,0 +1,32 @@
+// ItlwmCLI Random.h
+// Copyright 2026 by Calebh101
+//
+// A tiny xorshift64* generator, for things that want the same "random" numbers from the same seed on every platform (the
+// simulated driver and the benchmarks), which the standard library's engines and distributions don't promise.
+
+#ifndef Random_h
+#define Random_h
+
+#include <cstdint>
+
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed ? seed : 1) {} // xorshift gets stuck on 0
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+
+    // Anything from 'min' to 'max', both included
+    int range(int min, int max) {
+        return min + static_cast<int>(next() % static_cast<uint64_t>(max - min + 1));
+    }
+
+private:
+    uint64_t state;
+};
+
+#endif /* Random_h */
@@ -0,0 +1,101 @@
+// ItlwmCLI RedrawLimiter.h
+// Copyright 2026 by Calebh101
+//
+// Anything that changes what's on screen asks this for a redraw instead of posting one itself. Requests that come in faster than
+// the frame rate cap get folded into one, and when nothing's asking, nothing gets redrawn (and this thread just sleeps).
+
+#ifndef RedrawLimiter_h
+#define RedrawLimiter_h
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#define DEFAULT_MAX_FPS 30 // Default cap on how many redraws we ask for per second
+
+class RedrawLimiter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit RedrawLimiter(std::function<void()> post) : post(std::move(post)) {}
+
+    ~RedrawLimiter() {
+        stop();
+    }
+
+    void start(int maxFps = DEFAULT_MAX_FPS) {
+        setMaxFps(maxFps);
+        stopping = false;
+        worker = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        signal.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+
+    void setMaxFps(int maxFps) {
+        std::lock_guard<std::mutex> lock(mutex);
+        frameInterval = maxFps > 0 ? std::chrono::microseconds(1000000 / maxFps) : std::chrono::microseconds(0);
+    }
+
+    // Ask for a redraw. Safe to call from any thread, as often as you like.
+    void request() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pending) return; // Already on its way
+            pending = true;
+        }
+
+        signal.notify_one();
+    }
+
+    // How many redraws we've actually posted
+    unsigned long posted() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return posts;
+    }
+
+private:
+    std::function<void()> post;
+    mutable std::mutex mutex;
+    std::condition_variable signal;
+    std::thread worker;
+
+    bool pending = false;
+    bool stopping = false;
+    unsigned long posts = 0;
+    std::chrono::microseconds frameInterval{0};
+    clock::time_point lastPost;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            signal.wait(lock, [this] { return pending || stopping; });
+            if (stopping) return;
+
+            // Too soon after the last one? Wait it out; anything else that comes in meanwhile rides along with this one.
+            clock::time_point earliest = lastPost + frameInterval;
+            if (clock::now() < earliest) signal.wait_until(lock, earliest, [this] { return stopping; });
+            if (stopping) return;
+
+            pending = false;
+            lastPost = clock::now();
+            posts++;
+
+            lock.unlock();
+            post();
+            lock.lock();
+        }
+    }
+};
+
+#endif /* RedrawLimiter_h */
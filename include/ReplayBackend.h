@@ -0,0 +1,122 @@
+// ItlwmCLI ReplayBackend.h
+// Copyright 2026 by Calebh101
+//
+// Plays a capture (see Capture.h) back as if it were itlwm. Records come due as time passes (sped up by however much we were
+// asked to), and every call answers with whatever the capture said at that point, so the rest of the app can't tell it isn't
+// talking to the real thing. Once we run out of records, the last state just sticks around. The capture's memory-mapped, and
+// seek() jumps anywhere in it by way of its keyframe index, without reading everything before that point.
+//
+// Captures are read-only, so anything that would change itlwm's state fails.
+
+#ifndef ReplayBackend_h
+#define ReplayBackend_h
+
+#include "Capture.h"
+#include "StateBackend.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+class ReplayBackend : public StateBackend {
+public:
+    explicit ReplayBackend(double speed = 1.0) : speed(speed > 0 ? speed : 1.0) {}
+
+    // Returns false if the file can't be opened or isn't a capture we understand
+    bool open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!file.open(path)) return false;
+        this->path = path;
+        std::memset(&current, 0, sizeof(current));
+        offset = file.first();
+        loadNext();
+        firstTime = file.startTime();
+        start = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    // Jump to 'micros' into the capture (clamped to it), and carry on playing from there
+    void seek(int64_t micros) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int64_t time = file.startTime() + std::clamp<int64_t>(micros, 0, length());
+        offset = file.seek(time, current);
+        loadNext();
+        firstTime = time;
+        start = std::chrono::steady_clock::now();
+    }
+
+    // How far into the capture we are, in microseconds
+    int64_t position() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::min(now(), file.endTime()) - file.startTime();
+    }
+
+    // How long the capture is, in microseconds
+    int64_t length() const {
+        return file.endTime() - file.startTime();
+    }
+
+    std::string name() const override { return fmt::format("Replay of {} ({}x)", path, speed); }
+
+    // If we've played back everything there is
+    bool finished() {
+        std::lock_guard<std::mutex> lock(mutex);
+        update();
+        return !hasPending;
+    }
+
+    bool connectNetwork(const char*, const char*) override { return false; }
+    kern_return_t powerOn() override { return KERN_FAILURE; }
+    kern_return_t powerOff() override { return KERN_FAILURE; }
+    kern_return_t associateSsid(const char*, const char*) override { return KERN_FAILURE; }
+    kern_return_t disassociateSsid(const char*) override { return KERN_FAILURE; }
+
+    void terminate() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        file.close();
+    }
+
+private:
+    double speed;
+    std::string path;
+    CaptureFile file;
+    std::chrono::steady_clock::time_point start; // When we started playing from 'firstTime'
+    int64_t firstTime = 0; // Where in the capture we started playing from (the first record, unless we seeked)
+
+    size_t offset = 0; // Where the next record starts
+    const uint8_t* pending = nullptr; // The next record, which isn't due yet (pointing into the mapping, so never copied)
+    size_t pendingLength = 0;
+    size_t pendingNext = 0;
+    int64_t pendingTime = 0;
+    bool hasPending = false;
+
+    void loadNext() {
+        uint8_t fields;
+        hasPending = file.record(offset, pending, pendingLength, pendingNext) && peekCaptureRecord(pending, pendingLength, pendingTime, fields);
+    }
+
+    // Where in the capture we should be by now
+    int64_t now() const {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        return firstTime + static_cast<int64_t>(elapsed * speed);
+    }
+
+    // Apply every record that's come due
+    void update() override {
+        int64_t now = this->now();
+
+        while (hasPending && pendingTime <= now) {
+            if (!decodeCaptureRecord(pending, pendingLength, current)) { // Garbage from here on, so stop where we are
+                hasPending = false;
+                break;
+            }
+
+            offset = pendingNext;
+            loadNext();
+        }
+    }
+};
+
+#endif /* ReplayBackend_h */
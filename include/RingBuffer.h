@@ -0,0 +1,77 @@
+// ItlwmCLI RingBuffer.h
+// Copyright 2026 by Calebh101
+//
+// A fixed-size history that never allocates after it's made. New values overwrite the oldest ones once it's full.
+// One thread pushes; any number of threads can look at it through a View, which is just a couple of numbers, so handing one
+// to the renderer (or a graph callback) doesn't copy the history.
+
+#ifndef RingBuffer_h
+#define RingBuffer_h
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+template <typename T>
+class RingBuffer {
+public:
+    // A window onto the buffer as it was when the view was made. Index 0 is the oldest value, size() - 1 the newest.
+    class View {
+    public:
+        View() = default;
+        View(const RingBuffer* buffer, size_t total) : buffer(buffer), total(total), count(std::min(total, buffer->cap)) {}
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        T operator[](size_t i) const { return buffer->slots[(total - count + i) % buffer->cap].load(std::memory_order_relaxed); }
+        T back() const { return (*this)[count - 1]; }
+
+        // Just the newest 'n' values (or all of them, if there aren't that many)
+        View last(size_t n) const {
+            View view = *this;
+            view.count = std::min(n, count);
+            return view;
+        }
+
+    private:
+        const RingBuffer* buffer = nullptr;
+        size_t total = 0; // How many values had ever been pushed when this view was made
+        size_t count = 0;
+    };
+
+    explicit RingBuffer(size_t capacity) : slots(new std::atomic<T>[std::max<size_t>(capacity, 1)]()), cap(std::max<size_t>(capacity, 1)) {
+        static_assert(std::atomic<T>::is_always_lock_free, "RingBuffer values need to be lock-free atomics");
+    }
+
+    // Only ever call this from one thread
+    void push(T value) {
+        size_t n = total.load(std::memory_order_relaxed);
+        slots[n % cap].store(value, std::memory_order_relaxed);
+        total.store(n + 1, std::memory_order_release);
+    }
+
+    View view() const {
+        return View(this, total.load(std::memory_order_acquire));
+    }
+
+    size_t size() const {
+        return std::min(total.load(std::memory_order_acquire), cap);
+    }
+
+    size_t capacity() const {
+        return cap;
+    }
+
+    // How many values have ever been pushed (including ones that have since been overwritten)
+    size_t pushed() const {
+        return total.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<std::atomic<T>[]> slots;
+    size_t cap;
+    std::atomic<size_t> total{0};
+};
+
+#endif /* RingBuffer_h */
@@ -0,0 +1,131 @@
+// ItlwmCLI RssiPyramid.h
+// Copyright 2026 by Calebh101
+//
+// RSSI history at several zoom levels at once. Each level splits time into buckets (1 second, 4 seconds, 16 seconds and so on)
+// and keeps the min, max and mean of whatever landed in each one. Every value updates one bucket per level as it comes in, so
+// the graph can show the last minute or the last day by reading about as many buckets as it has columns.
+
+#ifndef RssiPyramid_h
+#define RssiPyramid_h
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#define PYRAMID_BASE_SPAN 1000  // How many milliseconds the finest buckets cover
+#define PYRAMID_FACTOR 4        // How many buckets of one level make up a bucket of the next
+#define PYRAMID_LEVELS 6        // How many levels there are (1s, 4s, 16s, 64s, 256s, 1024s)
+#define PYRAMID_BUCKETS 1024    // How many buckets each level keeps (the coarsest level covers about 12 days)
+
+// What a stretch of time looked like. 'count' is 0 if we didn't record anything in it.
+struct rssi_bucket {
+    int16_t min;
+    int16_t max;
+    int32_t sum;
+    uint32_t count;
+
+    int mean() const {
+        return count == 0 ? 0 : static_cast<int>(sum / static_cast<int32_t>(count));
+    }
+
+    void add(int16_t value) {
+        if (count == 0 || value < min) min = value;
+        if (count == 0 || value > max) max = value;
+        sum += value;
+        count++;
+    }
+
+    void merge(const rssi_bucket& other) {
+        if (other.count == 0) return;
+        if (count == 0 || other.min < min) min = other.min;
+        if (count == 0 || other.max > max) max = other.max;
+        sum += other.sum;
+        count += other.count;
+    }
+};
+
+class RssiPyramid {
+public:
+    using clock = std::chrono::steady_clock;
+
+    RssiPyramid() : start(clock::now()), levels(PYRAMID_LEVELS, std::vector<Slot>(PYRAMID_BUCKETS)) {}
+
+    // Milliseconds since the pyramid was made, which is what all the times in here are measured in
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count();
+    }
+
+    void push(int16_t value) {
+        push(now(), value);
+    }
+
+    void push(int64_t time, int16_t value) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (int level = 0; level < PYRAMID_LEVELS; level++) {
+            int64_t index = time / span(level);
+            Slot& slot = levels[level][index % PYRAMID_BUCKETS];
+
+            if (slot.index != index) { // Whatever was here is from a lap ago
+                slot.index = index;
+                slot.bucket = rssi_bucket{0, 0, 0, 0};
+            }
+
+            slot.bucket.add(value);
+        }
+    }
+
+    // Split the 'range' milliseconds before 'end' into 'columns' buckets, oldest first. Costs roughly the same for any range.
+    std::vector<rssi_bucket> query(int64_t end, int64_t range, int columns) const {
+        std::vector<rssi_bucket> result(std::max(columns, 0), rssi_bucket{0, 0, 0, 0});
+        if (columns <= 0 || range <= 0) return result;
+
+        int level = levelFor(range, columns);
+        int64_t bucketSpan = span(level);
+        int64_t begin = end - range;
+        int64_t first = std::max<int64_t>(begin / bucketSpan, end / bucketSpan - PYRAMID_BUCKETS + 1); // Anything older than that has been overwritten
+        int64_t last = end / bucketSpan;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (int64_t index = std::max<int64_t>(first, 0); index <= last; index++) {
+            const Slot& slot = levels[level][index % PYRAMID_BUCKETS];
+            if (slot.index != index) continue; // Nothing recorded then
+
+            int64_t middle = index * bucketSpan + bucketSpan / 2;
+            int64_t column = (middle - begin) * columns / range;
+            if (column < 0 || column >= columns) continue;
+            result[column].merge(slot.bucket);
+        }
+
+        return result;
+    }
+
+    // The coarsest level that still gives every column at least one bucket (so we never read more than PYRAMID_FACTOR buckets per column)
+    static int levelFor(int64_t range, int columns) {
+        int64_t perColumn = range / std::max(columns, 1);
+        int level = 0;
+        while (level + 1 < PYRAMID_LEVELS && span(level + 1) <= perColumn) level++;
+        return level;
+    }
+
+    static int64_t span(int level) {
+        int64_t span = PYRAMID_BASE_SPAN;
+        for (int i = 0; i < level; i++) span *= PYRAMID_FACTOR;
+        return span;
+    }
+
+private:
+    struct Slot {
+        int64_t index = -1; // Which bucket of its level this is holding right now
+        rssi_bucket bucket{0, 0, 0, 0};
+    };
+
+    clock::time_point start;
+    mutable std::mutex mutex;
+    std::vector<std::vector<Slot>> levels;
+};
+
+#endif /* RssiPyramid_h */
@@ -0,0 +1,103 @@
+// ItlwmCLI RssiStats.h
+// Copyright 2026 by Calebh101
+//
+// Keeps the minimum, maximum and average of the last N RSSI values up to date as they come in, so reading them costs the same
+// whether we have 10 values or 10,000. The min and max use monotonic queues: each one only holds the values that could still
+// end up being the min (or max) once older ones fall out of the window, so every value goes in and out of each queue once.
+
+#ifndef RssiStats_h
+#define RssiStats_h
+
+#include "Snapshot.h"
+#include <cstdlib>
+#include <memory>
+
+struct rssi_summary {
+    int min;
+    int max;
+    long long sumAbs; // Sum of the absolute values (RSSI is always negative)
+    size_t count;
+
+    // Same rounding the renderer has always used
+    int average() const {
+        return count == 0 ? 0 : -static_cast<int>(sumAbs / static_cast<long long>(count));
+    }
+};
+
+class RssiStats {
+public:
+    explicit RssiStats(size_t window) : window(window > 0 ? window : 1), values(new int16_t[this->window]()), minQueue(this->window), maxQueue(this->window) {}
+
+    // Only ever call this from one thread
+    void push(int16_t value) {
+        if (pushed >= window) { // Window's full, so the oldest one falls out
+            int16_t oldest = values[pushed % window];
+            sumAbs -= std::abs(oldest);
+            size_t evicted = pushed - window;
+            if (minQueue.front().index == evicted) minQueue.popFront();
+            if (maxQueue.front().index == evicted) maxQueue.popFront();
+        }
+
+        values[pushed % window] = value;
+        sumAbs += std::abs(value);
+
+        while (!minQueue.empty() && minQueue.back().value >= value) minQueue.popBack();
+        while (!maxQueue.empty() && maxQueue.back().value <= value) maxQueue.popBack();
+        minQueue.pushBack({pushed, value});
+        maxQueue.pushBack({pushed, value});
+        pushed++;
+
+        rssi_summary summary;
+        summary.min = minQueue.front().value;
+        summary.max = maxQueue.front().value;
+        summary.sumAbs = sumAbs;
+        summary.count = pushed < window ? pushed : window;
+        published.publish(summary);
+    }
+
+    // Safe to call from any thread
+    rssi_summary summary() const {
+        rssi_summary summary{0, 0, 0, 0};
+        published.read(summary);
+        return summary;
+    }
+
+private:
+    struct Entry {
+        size_t index; // Which push this was
+        int16_t value;
+    };
+
+    // A deque that never allocates; it can't ever hold more than 'window' entries
+    class Queue {
+    public:
+        explicit Queue(size_t capacity) : entries(new Entry[capacity]), capacity(capacity) {}
+
+        bool empty() const { return count == 0; }
+        const Entry& front() const { return entries[head]; }
+        const Entry& back() const { return entries[(head + count - 1) % capacity]; }
+        void pushBack(Entry entry) { entries[(head + count++) % capacity] = entry; }
+        void popBack() { count--; }
+
+        void popFront() {
+            head = (head + 1) % capacity;
+            count--;
+        }
+
+    private:
+        std::unique_ptr<Entry[]> entries;
+        size_t capacity;
+        size_t head = 0;
+        size_t count = 0;
+    };
+
+    size_t window;
+    std::unique_ptr<int16_t[]> values; // The window itself, so we know what's falling out
+    Queue minQueue; // Increasing values; the front is the minimum
+    Queue maxQueue; // Decreasing values; the front is the maximum
+    size_t pushed = 0;
+    long long sumAbs = 0;
+    SnapshotBuffer<rssi_summary> published;
+};
+
+#endif /* RssiStats_h */
@@ -0,0 +1,321 @@
+// ItlwmCLI SharedSnapshot.h
+// Copyright 2026 by Calebh101
+//
+// The newest snapshot in a memory-mapped file (with --shm), for things like status bar widgets that want to know the RSSI
+// right now without polling the driver, connecting to a daemon, or making a single syscall once they've mapped it. It's one
+// fixed, versioned struct (shared_snapshot_file), made out of fixed-size fields instead of the driver's own structs so other
+// languages can read it too, guarded by a sequence lock: the writer makes 'sequence' odd, changes things in place, and then
+// makes it even again. Readers look at the snapshot where it is, and if 'sequence' changed (or was odd) while they were
+// looking, they look again.
+//
+// Only what changed gets rewritten on each publish, so the scan list is only touched when there's a new one. The file's
+// never shrunk or moved, so readers can keep it mapped for as long as they like, even across restarts of ItlwmCLI.
+
+#ifndef SharedSnapshot_h
+#define SharedSnapshot_h
+
+#include "Capture.h"
+#include "Snapshot.h"
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#define SHARED_SNAPSHOT_MAGIC "ITLWMSHM"
+#define SHARED_SNAPSHOT_MAGIC_LENGTH 8
+#define SHARED_SNAPSHOT_VERSION 1
+#define SHARED_SNAPSHOT_CHECK_SPINS 1024 // How many times a reader finds a write in progress before it checks the writer's still alive
+
+// One network from the scan list (from ioctl_network_info)
+struct shared_network {
+    char ssid[MAX_SSID_LENGTH]; // Not null-terminated if it's the whole 32
+    uint8_t bssid[6];
+    int16_t rssi;
+    int16_t noise;
+    uint16_t reserved;
+    uint32_t channel;
+    uint32_t rsn_protos;
+    uint32_t rsn_akmps;
+    uint32_t rsn_ciphers;
+    uint32_t rsn_groupcipher;
+};
+
+// Our own connection (from station_info_t)
+struct shared_station {
+    uint32_t op_mode; // itl_phy_mode
+    int32_t max_mcs;
+    int32_t cur_mcs;
+    uint32_t channel;
+    uint32_t rate;
+    uint16_t band_width;
+    int16_t rssi;
+    int16_t noise;
+    uint8_t bssid[6];
+    char ssid[MAX_SSID_LENGTH];
+};
+
+struct shared_snapshot {
+    int64_t time; // When it was published, in Unix milliseconds
+    uint32_t ok; // Which parts are there, as bits: 1 ssid, 2 bssid, 4 state, 8 power, 16 platform, 32 networks, 64 station (see packSnapshotFlags())
+    uint32_t state; // 802.11 state
+    uint8_t power;
+    uint8_t reserved[7];
+    char ssid[MAX_SSID_LENGTH];
+    char bssid[32]; // As text, the way the driver gives it to us
+    shared_station station;
+    uint32_t networkCount;
+    uint32_t reserved2;
+    shared_network networks[MAX_NETWORK_LIST_LENGTH];
+};
+
+struct shared_snapshot_file {
+    char magic[SHARED_SNAPSHOT_MAGIC_LENGTH];
+    uint32_t version;
+    uint32_t size; // sizeof(shared_snapshot_file)
+    std::atomic<uint32_t> live; // 1 while something's publishing to it
+    uint32_t writer; // Its process ID
+    std::atomic<uint64_t> sequence; // Odd while it's being written, 0 until the first publish
+    shared_snapshot snapshot;
+};
+
+// The layout's the contract with readers, so it can't move without bumping SHARED_SNAPSHOT_VERSION
+static_assert(sizeof(shared_network) == 64 && sizeof(shared_station) == 64, "shared_snapshot layout changed");
+static_assert(offsetof(shared_snapshot, station) == 88 && offsetof(shared_snapshot, networks) == 160, "shared_snapshot layout changed");
+static_assert(offsetof(shared_snapshot_file, sequence) == 24 && offsetof(shared_snapshot_file, snapshot) == 32, "shared_snapshot_file layout changed");
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free, "the sequence has to work across processes");
+
+// Publishes snapshots to the file as the refresher makes them. Only ever use it from one thread.
+class SharedSnapshotWriter {
+public:
+    ~SharedSnapshotWriter() {
+        stop();
+    }
+
+    // Returns false (and why, in 'error') if the file couldn't be created, locked or mapped. It won't follow a symlink (so
+    // nobody can point it at a file of ours to have it overwritten), and it stays locked for as long as we're publishing to
+    // it, so a second ItlwmCLI with the same --shm fails here instead of publishing over the top of us.
+    bool start(const std::string& path, std::string& error) {
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0644);
+
+        if (fd < 0) {
+            error = errno == ELOOP ? "it's a symlink" : std::strerror(errno);
+            return false;
+        }
+
+        struct stat info;
+
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            error = "it isn't a regular file";
+            close(fd);
+            return false;
+        }
+
+        if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+            error = errno == EWOULDBLOCK ? "another ItlwmCLI is already publishing to it" : std::strerror(errno);
+            close(fd);
+            return false;
+        }
+
+        if (ftruncate(fd, sizeof(shared_snapshot_file)) != 0) {
+            error = std::strerror(errno);
+            close(fd);
+            return false;
+        }
+
+        void* mapping = mmap(nullptr, sizeof(shared_snapshot_file), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (mapping == MAP_FAILED) {
+            error = std::strerror(errno);
+            close(fd);
+            return false;
+        }
+
+        file = static_cast<shared_snapshot_file*>(mapping);
+        descriptor = fd; // Kept open for the lock
+
+        // If it's from an earlier run, pick its sequence up where it left off, so anyone who still has it mapped sees us start
+        bool ours = std::memcmp(file->magic, SHARED_SNAPSHOT_MAGIC, SHARED_SNAPSHOT_MAGIC_LENGTH) == 0 && file->version == SHARED_SNAPSHOT_VERSION && file->size == sizeof(shared_snapshot_file);
+        uint64_t sequence = ours ? (file->sequence.load(std::memory_order_relaxed) + 1) & ~1ULL : 0;
+        if (!ours) std::memset(static_cast<void*>(file), 0, sizeof(shared_snapshot_file));
+
+        file->version = SHARED_SNAPSHOT_VERSION;
+        file->size = sizeof(shared_snapshot_file);
+        file->writer = static_cast<uint32_t>(getpid());
+        file->sequence.store(sequence, std::memory_order_relaxed);
+        file->live.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(file->magic, SHARED_SNAPSHOT_MAGIC, SHARED_SNAPSHOT_MAGIC_LENGTH); // Last, so readers don't take a half-made file
+        first = true;
+        return true;
+    }
+
+    // Leaves the file there (with the last snapshot in it), just marked as not live any more
+    void stop() {
+        if (file == nullptr) return;
+        file->live.store(0, std::memory_order_release);
+        munmap(file, sizeof(shared_snapshot_file));
+        close(descriptor); // Lets go of the lock
+        file = nullptr;
+        descriptor = -1;
+    }
+
+    bool active() const {
+        return file != nullptr;
+    }
+
+    void publish(const itlwm_state& state) {
+        if (file == nullptr) return;
+        uint8_t fields = first ? static_cast<uint8_t>(capture_field_all) : changedFields(last, state.versions);
+        shared_snapshot& out = file->snapshot;
+
+        uint64_t sequence = file->sequence.load(std::memory_order_relaxed);
+        file->sequence.store(sequence + 1, std::memory_order_relaxed); // Odd means "being written"
+        std::atomic_thread_fence(std::memory_order_release);
+
+        out.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        out.ok = packSnapshotFlags(state.snapshot);
+        out.state = state.state;
+        out.power = state.power;
+        if (fields & capture_field_ssid) std::memcpy(out.ssid, state.ssid, sizeof(out.ssid));
+        if (fields & capture_field_bssid) std::memcpy(out.bssid, state.bssid, sizeof(out.bssid));
+
+        if (fields & capture_field_station) {
+            const station_info_t& station = state.station;
+            out.station.op_mode = static_cast<uint32_t>(station.op_mode);
+            out.station.max_mcs = station.max_mcs;
+            out.station.cur_mcs = station.cur_mcs;
+            out.station.channel = station.channel;
+            out.station.rate = station.rate;
+            out.station.band_width = station.band_width;
+            out.station.rssi = station.rssi;
+            out.station.noise = station.noise;
+            std::memcpy(out.station.bssid, station.bssid, sizeof(out.station.bssid));
+            std::memcpy(out.station.ssid, station.ssid, sizeof(out.station.ssid));
+        }
+
+        if (fields & capture_field_networks) {
+            int count = std::clamp(state.networks.count, 0, MAX_NETWORK_LIST_LENGTH);
+
+            for (int i = 0; i < count; i++) {
+                const ioctl_network_info& network = state.networks.networks[i];
+                shared_network& entry = out.networks[i];
+                std::memcpy(entry.ssid, network.ssid, sizeof(entry.ssid));
+                std::memcpy(entry.bssid, network.bssid, sizeof(entry.bssid));
+                entry.rssi = network.rssi;
+                entry.noise = network.noise;
+                entry.channel = network.channel;
+                entry.rsn_protos = network.rsn_protos;
+                entry.rsn_akmps = network.rsn_akmps;
+                entry.rsn_ciphers = network.rsn_ciphers;
+                entry.rsn_groupcipher = network.rsn_groupcipher;
+            }
+
+            out.networkCount = static_cast<uint32_t>(count);
+        }
+
+        file->sequence.store(sequence + 2, std::memory_order_release);
+        last = state.versions;
+        first = false;
+    }
+
+private:
+    shared_snapshot_file* file = nullptr;
+    int descriptor = -1; // Holds the flock() on the file
+    itlwm_versions last{};
+    bool first = true;
+};
+
+// For reading the file from another process (or from C++ in this one)
+class SharedSnapshotReader {
+public:
+    ~SharedSnapshotReader() {
+        close();
+    }
+
+    // Returns false if there's no file there, or it's not one we understand
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(shared_snapshot_file))) {
+            ::close(fd);
+            return false;
+        }
+
+        void* mapping = mmap(nullptr, sizeof(shared_snapshot_file), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) return false;
+        file = static_cast<const shared_snapshot_file*>(mapping);
+
+        if (std::memcmp(file->magic, SHARED_SNAPSHOT_MAGIC, SHARED_SNAPSHOT_MAGIC_LENGTH) != 0 || file->version != SHARED_SNAPSHOT_VERSION || file->size != sizeof(shared_snapshot_file)) {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void close() {
+        if (file == nullptr) return;
+        munmap(const_cast<shared_snapshot_file*>(file), sizeof(shared_snapshot_file));
+        file = nullptr;
+    }
+
+    // If something's publishing to it right now
+    bool live() const {
+        return file->live.load(std::memory_order_acquire) != 0;
+    }
+
+    // If the process that publishes to it is still around. 'live' only gets cleared by a clean stop(), so this is how we
+    // find out it was killed instead.
+    bool writerAlive() const {
+        pid_t writer = static_cast<pid_t>(file->writer);
+        return writer <= 0 || kill(writer, 0) == 0 || errno != ESRCH;
+    }
+
+    // How many times it's been published to (times two), without looking at anything else, to check for anything new
+    uint64_t sequence() const {
+        return file->sequence.load(std::memory_order_acquire);
+    }
+
+    // Calls 'read' with the snapshot right where it is (nothing's copied), over again until it gets through once without the
+    // writer changing it underneath. Since it might be looking mid-write, 'read' has to cope with garbage (like a networkCount
+    // that's too big) without crashing; it'll just be called again. Returns the sequence it read, or 0 if there's nothing yet
+    // (or the writer died halfway through a write, so there's nothing whole to read until it's restarted).
+    template <typename F>
+    uint64_t read(F&& read) const {
+        uint32_t spins = 0;
+
+        while (true) {
+            uint64_t before = file->sequence.load(std::memory_order_acquire);
+            if (before == 0) return 0;
+
+            if (before & 1) { // Writer's in there right now
+                if (!live()) return 0; // ...or it was, and stopped mid-write
+                if (++spins % SHARED_SNAPSHOT_CHECK_SPINS == 0 && !writerAlive()) return 0; // ...or it was killed mid-write
+                continue;
+            }
+
+            read(file->snapshot);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (file->sequence.load(std::memory_order_relaxed) == before) return before;
+        }
+    }
+
+private:
+    const shared_snapshot_file* file = nullptr;
+};
+
+#endif /* SharedSnapshot_h */
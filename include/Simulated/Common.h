@@ -0,0 +1,61 @@
+// ItlwmCLI Simulated/Common.h
+// Copyright 2026 by Calebh101
+//
+// Stand-in for HeliPort's ClientKit/Common.h, with just the types ItlwmCLI uses. The layouts follow ClientKit's so that code
+// built against this behaves the same as code built against the real thing.
+
+#ifndef Common_h
+#define Common_h
+
+#include <stdint.h>
+
+#define NWID_LEN 32
+#define ETHER_ADDR_LEN 6
+
+enum itl80211_state {
+    ITL80211_S_INIT = 0,    /* default state */
+    ITL80211_S_SCAN = 1,    /* scanning */
+    ITL80211_S_AUTH = 2,    /* try to authenticate */
+    ITL80211_S_ASSOC = 3,   /* try to assoc */
+    ITL80211_S_RUN = 4      /* associated */
+};
+
+enum itl_phy_mode {
+    ITL80211_MODE_11A = 1 << 0,
+    ITL80211_MODE_11B = 1 << 1,
+    ITL80211_MODE_11G = 1 << 2,
+    ITL80211_MODE_11N = 1 << 3,
+    ITL80211_MODE_11AC = 1 << 4,
+    ITL80211_MODE_11AX = 1 << 5,
+};
+
+struct ioctl_sta_info {
+    unsigned int version;
+    enum itl_phy_mode op_mode;
+    int32_t max_mcs;
+    int32_t cur_mcs;
+    uint32_t channel;
+    uint16_t band_width;
+    int16_t rssi;
+    int16_t noise;
+    unsigned int rate;
+    unsigned char ssid[NWID_LEN];
+    uint8_t bssid[ETHER_ADDR_LEN];
+};
+
+struct ioctl_network_info {
+    unsigned char ssid[NWID_LEN];
+    int16_t noise;
+    int16_t rssi;
+    uint8_t bssid[ETHER_ADDR_LEN];
+    uint32_t channel;
+    unsigned int supported_rsnprotos;
+    unsigned int rsn_protos;
+    unsigned int supported_rsnakmps;
+    unsigned int rsn_akmps;
+    unsigned int rsn_ciphers;
+    unsigned int rsn_groupcipher;
+    unsigned int rsn_groupmgmtcipher;
+};
+
+#endif /* Common_h */
@@ -0,0 +1,16 @@
+// ItlwmCLI Simulated/IOKit/IOKitLib.h
+// Copyright 2026 by Calebh101
+//
+// Stand-in for the bits of IOKit that Api.h needs, for building against the simulated driver on machines without IOKit.
+// Nothing in here actually talks to a driver.
+
+#ifndef IOKitLib_h
+#define IOKitLib_h
+
+typedef int kern_return_t;
+typedef unsigned int io_connect_t;
+
+#define KERN_SUCCESS 0
+#define KERN_FAILURE 5
+
+#endif /* IOKitLib_h */
@@ -0,0 +1,11 @@
+// ItlwmCLI Simulated/IOKit/IOTypes.h
+// Copyright 2026 by Calebh101
+//
+// Stand-in for IOKit's IOTypes.h. Everything Api.h needs already lives in IOKitLib.h.
+
+#ifndef IOTypes_h
+#define IOTypes_h
+
+#include "IOKitLib.h"
+
+#endif /* IOTypes_h */
@@ -0,0 +1,282 @@
+// ItlwmCLI SimulatedBackend.h
+// Copyright 2026 by Calebh101
+//
+// A fake itlwm that lives entirely in-process. It makes up a scan list, wanders the RSSI values around and walks through the
+// same 802.11 states the real driver does, so the app can be run (and profiled) on machines that don't have an Intel card.
+// Given the same seed, the simulation always plays out the same way.
+
+#ifndef SimulatedBackend_h
+#define SimulatedBackend_h
+
+#include "Backend.h"
+#include "Random.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+struct simulation_options {
+    int networks = 24;         // How many networks the scan list has (capped at MAX_NETWORK_LIST_LENGTH)
+    uint64_t seed = 1;         // Same seed, same simulation
+    int tickInterval = 100;    // How many milliseconds of real time one simulation step takes (<= 0 to only step manually)
+    int rssiStep = 2;          // How far an RSSI value can wander in one step
+    int dropChance = 5;        // Chance (out of 10000, per step) that an established connection drops
+    bool startConnected = true; // If we should start out connected to the strongest network
+};
+
+class SimulatedBackend : public Backend {
+public:
+    explicit SimulatedBackend(simulation_options options = simulation_options()) : options(options), random(options.seed) {
+        this->options.networks = std::clamp(options.networks, 0, MAX_NETWORK_LIST_LENGTH);
+        this->start = std::chrono::steady_clock::now();
+        generateNetworks();
+
+        if (this->options.startConnected && scanList.count > 0) {
+            int strongest = 0;
+
+            for (int i = 1; i < scanList.count; i++) {
+                if (scanList.networks[i].rsn_protos == 0 && scanList.networks[i].ssid[0] != 0 && scanList.networks[i].rssi > scanList.networks[strongest].rssi) strongest = i;
+            }
+
+            target = strongest;
+            connected = strongest;
+            state = ITL80211_S_RUN;
+        }
+    }
+
+    std::string name() const override { return "Simulated itlwm"; }
+
+    bool getPlatformInfo(platform_info_t* result) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        std::memset(result, 0, sizeof(platform_info_t));
+        std::snprintf(result->device_info_str, sizeof(result->device_info_str), "%s", "sim0");
+        std::snprintf(result->driver_info_str, sizeof(result->driver_info_str), "%s", "v2.3.0 (simulated)");
+        return true;
+    }
+
+    bool getPowerState(bool* enabled) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        *enabled = power;
+        return true;
+    }
+
+    bool get80211State(uint32_t* state) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        *state = this->state;
+        return true;
+    }
+
+    bool getNetworkSsid(char* ssid) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        if (!power || connected < 0) return false;
+        std::memcpy(ssid, scanList.networks[connected].ssid, MAX_SSID_LENGTH);
+        return true;
+    }
+
+    bool getNetworkBssid(char* bssid) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        if (!power || connected < 0) return false;
+        const uint8_t* b = scanList.networks[connected].bssid;
+        std::snprintf(bssid, 32, "%02x:%02x:%02x:%02x:%02x:%02x", b[0], b[1], b[2], b[3], b[4], b[5]); // Same format ClientKit uses
+        return true;
+    }
+
+    bool getNetworkList(network_info_list_t* list) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        if (!power) return false;
+        list->count = scanList.count;
+        std::memcpy(list->networks, scanList.networks, sizeof(ioctl_network_info) * scanList.count);
+        return true;
+    }
+
+    kern_return_t getStationInfo(station_info_t* info) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        std::memset(info, 0, sizeof(station_info_t));
+        if (!power || connected < 0 || state != ITL80211_S_RUN) return KERN_FAILURE;
+
+        const ioctl_network_info& network = scanList.networks[connected];
+        info->op_mode = network.channel > 14 ? ITL80211_MODE_11AC : ITL80211_MODE_11N;
+        info->channel = network.channel;
+        info->band_width = network.channel > 14 ? 80 : 20;
+        info->rssi = network.rssi;
+        info->noise = network.noise;
+        info->rate = static_cast<unsigned int>(std::max(6, (network.rssi + 100) * (network.channel > 14 ? 12 : 3))); // Close enough
+        info->max_mcs = network.channel > 14 ? 9 : 7;
+        info->cur_mcs = std::clamp((network.rssi + 90) / 6, 0, info->max_mcs);
+        std::memcpy(info->ssid, network.ssid, sizeof(info->ssid));
+        std::memcpy(info->bssid, network.bssid, sizeof(info->bssid));
+        return KERN_SUCCESS;
+    }
+
+    bool connectNetwork(const char* ssid, const char* pwd) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        if (!power) return false;
+
+        target = find(ssid);
+        targetPasswordOk = target >= 0 && (scanList.networks[target].rsn_protos == 0 || (pwd != nullptr && std::strlen(pwd) >= 8));
+        connected = -1;
+        state = ITL80211_S_SCAN;
+        stateTicks = 0;
+        return true;
+    }
+
+    kern_return_t powerOn() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        power = true;
+        state = ITL80211_S_INIT;
+        stateTicks = 0;
+        if (target >= 0) state = ITL80211_S_SCAN; // itlwm reconnects on its own when it comes back up
+        return KERN_SUCCESS;
+    }
+
+    kern_return_t powerOff() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        power = false;
+        connected = -1;
+        state = ITL80211_S_INIT;
+        return KERN_SUCCESS;
+    }
+
+    kern_return_t associateSsid(const char* ssid, const char* /* pwd */) override { // Every simulated network takes any password
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        return find(ssid) >= 0 ? KERN_SUCCESS : KERN_FAILURE;
+    }
+
+    kern_return_t disassociateSsid(const char* ssid) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        advance();
+        int index = find(ssid);
+        if (index < 0) return KERN_FAILURE;
+
+        if (index == target) {
+            target = -1;
+            connected = -1;
+            state = ITL80211_S_INIT;
+        }
+
+        return KERN_SUCCESS;
+    }
+
+    void terminate() override {}
+
+    // Run a specific number of simulation steps, no matter how much time actually passed. Useful for benchmarks, or with tickInterval <= 0.
+    void step(int steps = 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < steps; i++) tick();
+    }
+
+private:
+    simulation_options options;
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point start;
+    Random random; // Our own, so the same seed always plays out the same way
+    uint64_t ticks = 0; // How many steps have been run so far
+
+    network_info_list_t scanList{};
+    bool power = true;
+    uint32_t state = ITL80211_S_INIT;
+    int stateTicks = 0; // How many steps we've been in the current state
+    int target = -1; // Index of the network we want to be on
+    int connected = -1; // Index of the network we're actually on
+    bool targetPasswordOk = true;
+
+    int find(const char* ssid) {
+        if (ssid == nullptr) return -1;
+
+        for (int i = 0; i < scanList.count; i++) {
+            if (std::strncmp(reinterpret_cast<const char*>(scanList.networks[i].ssid), ssid, MAX_SSID_LENGTH) == 0) return i;
+        }
+
+        return -1;
+    }
+
+    void generateNetworks() {
+        static const char* names[] = {"Home", "Office", "Guest", "Library", "Cafe", "Lab", "Studio", "Garage", "Attic", "Lobby"};
+        static const uint32_t channels[] = {1, 6, 11, 36, 40, 44, 48, 149, 153, 157, 161};
+
+        scanList.count = options.networks;
+
+        for (int i = 0; i < scanList.count; i++) {
+            ioctl_network_info& network = scanList.networks[i];
+            std::memset(&network, 0, sizeof(network));
+
+            if (i % 11 != 10) { // Every now and then there's a hidden network
+                std::snprintf(reinterpret_cast<char*>(network.ssid), sizeof(network.ssid), "%s-%03d", names[i % 10], i + 1);
+            }
+
+            for (auto& byte : network.bssid) byte = static_cast<uint8_t>(random.next());
+            network.bssid[0] &= 0xFE; // Unicast
+            network.channel = channels[random.range(0, sizeof(channels) / sizeof(channels[0]) - 1)];
+            network.rssi = static_cast<int16_t>(random.range(-90, -35));
+            network.noise = static_cast<int16_t>(random.range(-98, -88));
+            network.rsn_protos = i % 4 == 0 ? 0 : 2; // A quarter of them are open
+        }
+    }
+
+    // Catch up with real time
+    void advance() {
+        if (options.tickInterval <= 0) return;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        uint64_t due = static_cast<uint64_t>(elapsed / options.tickInterval);
+        while (ticks < due) tick();
+    }
+
+    void tick() {
+        ticks++;
+        stateTicks++;
+
+        if (power) {
+            for (int i = 0; i < scanList.count; i++) { // Everything wanders around a little
+                ioctl_network_info& network = scanList.networks[i];
+                network.rssi = static_cast<int16_t>(std::clamp(network.rssi + random.range(-options.rssiStep, options.rssiStep), -95, -30));
+                network.noise = static_cast<int16_t>(std::clamp(network.noise + random.range(-1, 1), -100, -85));
+            }
+        }
+
+        if (!power) return;
+
+        switch (state) {
+            case ITL80211_S_INIT:
+                break;
+            case ITL80211_S_SCAN:
+                if (stateTicks >= 3) setState(target >= 0 ? ITL80211_S_AUTH : ITL80211_S_INIT);
+                break;
+            case ITL80211_S_AUTH:
+                if (stateTicks >= 4) setState(targetPasswordOk ? ITL80211_S_ASSOC : ITL80211_S_INIT);
+                break;
+            case ITL80211_S_ASSOC:
+                if (stateTicks >= 3) {
+                    connected = target;
+                    setState(ITL80211_S_RUN);
+                }
+
+                break;
+            case ITL80211_S_RUN:
+                if (random.range(0, 9999) < options.dropChance) { // Lost it, so go looking again
+                    connected = -1;
+                    setState(ITL80211_S_SCAN);
+                }
+
+                break;
+        }
+    }
+
+    void setState(uint32_t state) {
+        this->state = state;
+        stateTicks = 0;
+    }
+};
+
+#endif /* SimulatedBackend_h */
@@ -0,0 +1,102 @@
+// ItlwmCLI Snapshot.h
+// Copyright 2026 by Calebh101
+//
+// What we know about itlwm at a single point in time, and the buffer the refresher publishes it through.
+
+#ifndef Snapshot_h
+#define Snapshot_h
+
+#include "Api.h"
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+// Which parts of the last poll actually worked
+struct itlwm_snapshot {
+    bool ssid_ok;
+    bool bssid_ok;
+    bool state_ok;
+    bool power_ok;
+    bool platform_ok;
+    bool networks_ok;
+    bool station_ok;
+};
+
+// Bumped whenever the matching part of itlwm_state actually changes, so readers can skip work when nothing did
+struct itlwm_versions {
+    uint32_t power;
+    uint32_t state;
+    uint32_t ssid;
+    uint32_t bssid;
+    uint32_t platform;
+    uint32_t networks;
+    uint32_t station;
+};
+
+// Everything one poll of itlwm gives us
+struct itlwm_state {
+    itlwm_snapshot snapshot;
+    itlwm_versions versions;
+    char ssid[MAX_SSID_LENGTH];
+    char bssid[32];
+    bool power;
+    uint32_t state;
+    platform_info_t platform;
+    network_info_list_t networks;
+    station_info_t station;
+};
+
+// Single-writer, many-reader publication without locks. The writer fills its own copy however slowly it likes, then publish()
+// copies it into whichever of the two slots readers aren't looking at and flips the index. Readers copy the newest slot out and
+// only retry if the writer lapped them mid-copy (which takes two whole publishes), so nobody ever waits on driver I/O.
+template <typename T>
+class SnapshotBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "SnapshotBuffer needs something it can memcpy");
+
+public:
+    // Only ever call this from one thread
+    void publish(const T& value) {
+        uint64_t next = published.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots[next & 1];
+
+        uint64_t version = slot.version.load(std::memory_order_relaxed);
+        slot.version.store(version + 1, std::memory_order_relaxed); // Odd means "being written"
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.value, &value, sizeof(T));
+        slot.version.store(version + 2, std::memory_order_release);
+
+        published.store(next, std::memory_order_release);
+    }
+
+    // Copy the newest value into 'out'. Returns how many values have been published so far (0 means 'out' wasn't touched).
+    uint64_t read(T& out) const {
+        while (true) {
+            uint64_t current = published.load(std::memory_order_acquire);
+            if (current == 0) return 0;
+            const Slot& slot = slots[current & 1];
+
+            uint64_t before = slot.version.load(std::memory_order_acquire);
+            if (before & 1) continue; // Writer's in there right now
+
+            std::memcpy(&out, &slot.value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) == before) return current;
+        }
+    }
+
+    // How many values have been published, without copying anything
+    uint64_t sequence() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> version{0};
+        T value{};
+    };
+
+    Slot slots[2];
+    std::atomic<uint64_t> published{0};
+};
+
+#endif /* Snapshot_h */
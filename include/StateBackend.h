@@ -0,0 +1,75 @@
+// ItlwmCLI StateBackend.h
+// Copyright 2026 by Calebh101
+//
+// A backend that answers from an itlwm_state it keeps, instead of asking a driver. Whatever keeps that state up to date (a
+// capture being played back, a daemon we're subscribed to) just overrides update() and the calls that change itlwm's state.
+
+#ifndef StateBackend_h
+#define StateBackend_h
+
+#include "Backend.h"
+#include "Snapshot.h"
+#include <cstring>
+#include <mutex>
+
+class StateBackend : public Backend {
+public:
+    bool getPlatformInfo(platform_info_t* result) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        update();
+        *result = current.platform;
+        return current.snapshot.platform_ok;
+    }
+
+    bool getPowerState(bool* enabled) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        update();
+        *enabled = current.power;
+        return current.snapshot.power_ok;
+    }
+
+    bool get80211State(uint32_t* state) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        update();
+        *state = current.state;
+        return current.snapshot.state_ok;
+    }
+
+    bool getNetworkSsid(char* ssid) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        update();
+        std::memcpy(ssid, current.ssid, MAX_SSID_LENGTH);
+        return current.snapshot.ssid_ok;
+    }
+
+    bool getNetworkBssid(char* bssid) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        update();
+        std::memcpy(bssid, current.bssid, sizeof(current.bssid));
+        return current.snapshot.bssid_ok;
+    }
+
+    bool getNetworkList(network_info_list_t* list) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        update();
+        list->count = current.networks.count;
+        std::memcpy(list->networks, current.networks.networks, sizeof(ioctl_network_info) * current.networks.count);
+        return current.snapshot.networks_ok;
+    }
+
+    kern_return_t getStationInfo(station_info_t* info) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        update();
+        *info = current.station;
+        return current.snapshot.station_ok ? KERN_SUCCESS : KERN_FAILURE;
+    }
+
+protected:
+    std::mutex mutex; // Guards 'current' (and whatever subclasses keep alongside it)
+    itlwm_state current{};
+
+    // Bring 'current' up to date; called with 'mutex' held, before every answer
+    virtual void update() {}
+};
+
+#endif /* StateBackend_h */
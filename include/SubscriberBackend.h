@@ -0,0 +1,219 @@
+// ItlwmCLI SubscriberBackend.h
+// Copyright 2026 by Calebh101
+//
+// Attaches to a daemon (see Daemon.h) instead of talking to itlwm, for --attach. A thread reads the daemon's records as they
+// come in and applies them to the state StateBackend answers from, so polling this never leaves the process, and the driver
+// only ever gets polled once no matter how many of us there are. Calls that change something get forwarded to the daemon,
+// which makes them for us.
+//
+// We only talk to a daemon running as our own user (or root), so nobody else can feed us made-up state or collect the
+// passwords we forward; see trustedPeer().
+//
+// If the daemon goes away, everything reads as unavailable until we manage to reconnect, which we keep trying to do.
+
+#ifndef SubscriberBackend_h
+#define SubscriberBackend_h
+
+#include "Capture.h"
+#include "Daemon.h"
+#include "StateBackend.h"
+#include <fmt/format.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+class SubscriberBackend : public StateBackend {
+public:
+    // 'updated' is called (on the reader thread) whenever something comes in, so the refresher can pick it up right away
+    SubscriberBackend(std::string path, std::function<void()> updated) : path(std::move(path)), updated(std::move(updated)) {}
+
+    ~SubscriberBackend() {
+        terminate();
+    }
+
+    // Returns false if there's no daemon listening, or it isn't running as us (we only keep trying once we've gotten through
+    // the first time)
+    bool start() {
+        int fd = subscribe();
+        if (fd < 0) return false;
+        connection = fd;
+        reader = std::thread([this] { receive(); });
+        return true;
+    }
+
+    std::string name() const override { return fmt::format("Daemon at {}", path); }
+
+    bool connectNetwork(const char* ssid, const char* pwd) override { return call(fmt::format("connect_network {} {}", quoteArgument(ssid), quoteArgument(pwd))).value_or(0) != 0; }
+    kern_return_t powerOn() override { return static_cast<kern_return_t>(call("power_on").value_or(KERN_FAILURE)); }
+    kern_return_t powerOff() override { return static_cast<kern_return_t>(call("power_off").value_or(KERN_FAILURE)); }
+    kern_return_t associateSsid(const char* ssid, const char* pwd) override { return static_cast<kern_return_t>(call(fmt::format("associate_ssid {} {}", quoteArgument(ssid), quoteArgument(pwd))).value_or(KERN_FAILURE)); }
+    kern_return_t disassociateSsid(const char* ssid) override { return static_cast<kern_return_t>(call(fmt::format("dis_associate_ssid {}", quoteArgument(ssid))).value_or(KERN_FAILURE)); }
+
+    void terminate() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            if (connection >= 0) shutdown(connection, SHUT_RDWR); // Gets the reader out of recv()
+        }
+
+        retry.notify_all();
+        if (reader.joinable()) reader.join();
+    }
+
+private:
+    std::string path;
+    std::function<void()> updated;
+    std::thread reader;
+    std::condition_variable retry;
+    int connection = -1; // Guarded by 'mutex', like 'stopping'
+    bool stopping = false;
+
+    // Connects, and makes sure it's really our daemon on the other end (not someone else's socket, who'd love our passwords)
+    int connect() {
+        int fd = connectDaemon(path);
+        if (fd < 0) return -1;
+
+        if (!trustedPeer(fd)) {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    // Returns the socket, with the request already sent, or -1
+    int subscribe() {
+        int fd = connect();
+        if (fd < 0) return -1;
+        static const char request[] = "SUBSCRIBE binary\n";
+
+        if (!sendAll(fd, request, sizeof(request) - 1)) {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    // The reader thread: apply records until the daemon goes away, then keep trying to get it back
+    void receive() {
+        std::vector<uint8_t> buffer;
+        buffer.reserve(sizeof(itlwm_state) * 2);
+
+        while (true) {
+            int fd;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                fd = connection;
+            }
+
+            if (fd >= 0) {
+                apply(fd, buffer);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                close(fd);
+                connection = -1;
+                forget();
+            }
+
+            if (updated) updated();
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                retry.wait_for(lock, std::chrono::milliseconds(DAEMON_RECONNECT_INTERVAL), [this] { return stopping; });
+                if (stopping) return;
+            }
+
+            fd = subscribe();
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (stopping) { // Gave up on us while we were connecting
+                if (fd >= 0) close(fd);
+                return;
+            }
+
+            connection = fd;
+        }
+    }
+
+    // We don't know anything any more, so don't leave the old values around to be read, and bump every version so anything
+    // that diffs by version sees everything change. Called with 'mutex' held.
+    void forget() {
+        itlwm_versions versions = current.versions;
+        std::memset(&current, 0, sizeof(current));
+        current.versions = {versions.power + 1, versions.state + 1, versions.ssid + 1, versions.bssid + 1, versions.platform + 1, versions.networks + 1, versions.station + 1};
+    }
+
+    // Reads and applies records from 'fd' until it closes (or sends something that makes no sense)
+    void apply(int fd, std::vector<uint8_t>& buffer) {
+        buffer.clear();
+        size_t at = 0;
+        bool header = false;
+        uint8_t chunk[16384];
+
+        while (true) {
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+
+            if (received < 0 && errno == EINTR) continue;
+            if (received <= 0) return;
+            buffer.insert(buffer.end(), chunk, chunk + received);
+
+            if (!header) {
+                if (buffer.size() < CAPTURE_HEADER_SIZE) continue;
+                if (readCaptureHeader(buffer.data(), buffer.size()) == 0) return; // Not a daemon we understand
+                at = CAPTURE_HEADER_SIZE;
+                header = true;
+            }
+
+            bool any = false;
+
+            while (buffer.size() - at >= sizeof(uint32_t)) {
+                uint32_t length;
+                std::memcpy(&length, buffer.data() + at, sizeof(length));
+                if (length > sizeof(itlwm_state) * 2) return; // Garbage
+                if (buffer.size() - at - sizeof(length) < length) break; // The rest hasn't come in yet
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!decodeCaptureRecord(buffer.data() + at + sizeof(length), length, current)) return;
+                at += sizeof(length) + length;
+                any = true;
+            }
+
+            buffer.erase(buffer.begin(), buffer.begin() + at);
+            at = 0;
+            if (any && updated) updated();
+        }
+    }
+
+    // Has the daemon make a call for us, and returns what it returned (or nothing, if we couldn't reach it)
+    std::optional<long> call(const std::string& command) {
+        int fd = connect();
+        if (fd < 0) return std::nullopt;
+        std::string request = fmt::format("CALL {}\n", command);
+        std::string reply;
+
+        if (sendAll(fd, request.data(), request.size())) {
+            char chunk[256];
+            ssize_t received;
+
+            while (reply.find('\n') == std::string::npos && ((received = recv(fd, chunk, sizeof(chunk), 0)) > 0 || (received < 0 && errno == EINTR))) {
+                if (received > 0) reply.append(chunk, received);
+            }
+        }
+
+        close(fd);
+        if (reply.compare(0, 3, "OK ") != 0) return std::nullopt;
+        return std::strtol(reply.c_str() + 3, nullptr, 10);
+    }
+};
+
+#endif /* SubscriberBackend_h */
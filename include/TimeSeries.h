@@ -0,0 +1,249 @@
+// ItlwmCLI TimeSeries.h
+// Copyright 2026 by Calebh101
+//
+// Long-term, compressed history of what get_station_info tells us (RSSI, noise and rate). Samples are packed into chunks: the
+// first one in each chunk is stored as-is, and everything after it only stores how much it changed from the one before (and
+// the timestamps how much their spacing changed), as varints. Values that barely move take a byte or two each, so days of
+// history fit in a few megabytes. Once a chunk fills up it's sealed and never touched again until it's the oldest and we're
+// over budget, at which point it's dropped.
+//
+// Every chunk also keeps the min, max and sum of each metric, so a zoomed-out graph can use a whole chunk at once whenever it
+// lands inside one column, and only has to decode the chunks that straddle columns. That's never more than a couple per
+// column, so drawing a day costs about the same as drawing an hour.
+
+#ifndef TimeSeries_h
+#define TimeSeries_h
+
+#include "RssiPyramid.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#define TIME_SERIES_CHUNK_SAMPLES 256 // How many samples go in a chunk before it's sealed
+
+enum station_metric {
+    station_metric_rssi,
+    station_metric_noise,
+    station_metric_rate,
+    station_metric_count,
+};
+
+struct station_sample {
+    int64_t time; // Milliseconds since the series was made
+    int16_t rssi;
+    int16_t noise;
+    uint32_t rate;
+
+    int value(station_metric metric) const {
+        switch (metric) {
+            case station_metric_rssi: return rssi;
+            case station_metric_noise: return noise;
+            case station_metric_rate: return static_cast<int>(std::min<uint32_t>(rate, INT16_MAX));
+            case station_metric_count: break;
+        }
+
+        return 0;
+    }
+};
+
+class StationSeries {
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit StationSeries(size_t maxBytes) : start(clock::now()), maxBytes(maxBytes) {}
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count();
+    }
+
+    // Cheap enough to do on every poll: a handful of varints into memory that's already there
+    void push(const station_sample& sample) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (chunks.empty() || chunks.back().count >= TIME_SERIES_CHUNK_SAMPLES) {
+            if (!chunks.empty()) chunks.back().bytes.shrink_to_fit(); // Sealed, so give back the slack
+            chunks.emplace_back();
+            chunks.back().bytes.reserve(TIME_SERIES_CHUNK_SAMPLES * 6);
+            chunks.back().first = sample.time;
+        }
+
+        for (int metric = 0; metric < station_metric_count; metric++) chunks.back().summary[metric].add(static_cast<int16_t>(sample.value(static_cast<station_metric>(metric))));
+
+        Chunk& chunk = chunks.back();
+        size_t before = chunk.bytes.size();
+
+        if (chunk.count == 0) {
+            putVarint(chunk.bytes, zigzag(sample.time));
+            putVarint(chunk.bytes, zigzag(sample.rssi));
+            putVarint(chunk.bytes, zigzag(sample.noise));
+            putVarint(chunk.bytes, sample.rate);
+            previousDelta = 0;
+        } else {
+            int64_t delta = sample.time - previous.time;
+            putVarint(chunk.bytes, zigzag(delta - previousDelta)); // Usually 0, since we record on a steady interval
+            putVarint(chunk.bytes, zigzag(sample.rssi - previous.rssi));
+            putVarint(chunk.bytes, zigzag(sample.noise - previous.noise));
+            putVarint(chunk.bytes, zigzag(static_cast<int64_t>(sample.rate) - static_cast<int64_t>(previous.rate)));
+            previousDelta = delta;
+        }
+
+        chunk.last = sample.time;
+        chunk.count++;
+        previous = sample;
+        totalBytes += chunk.bytes.size() - before;
+        totalSamples++;
+
+        while (chunks.size() > 1 && totalBytes > maxBytes) { // Over budget, so the oldest chunk goes
+            totalBytes -= chunks.front().bytes.size();
+            totalSamples -= chunks.front().count;
+            chunks.pop_front();
+        }
+    }
+
+    // The newest 'n' samples, oldest first. Only decodes the chunks it needs, starting from the newest.
+    std::vector<station_sample> tail(size_t n) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<station_sample> result;
+        size_t needed = 0;
+        size_t firstChunk = chunks.size();
+
+        while (firstChunk > 0 && needed < n) needed += chunks[--firstChunk].count;
+
+        for (size_t i = firstChunk; i < chunks.size(); i++) decode(chunks[i], result);
+        if (result.size() > n) result.erase(result.begin(), result.end() - n);
+        return result;
+    }
+
+    // Bucket one metric over the 'range' milliseconds before 'end' into 'columns' buckets, oldest first. Chunks that fit in a
+    // column just add their summary; the few that don't get copied out and decoded after the lock's let go, so push() (on
+    // the refresher) never waits on us for long.
+    std::vector<rssi_bucket> query(station_metric metric, int64_t end, int64_t range, int columns) const {
+        std::vector<rssi_bucket> result(std::max(columns, 0), rssi_bucket{0, 0, 0, 0});
+        if (columns <= 0 || range <= 0) return result;
+        int64_t begin = end - range;
+        auto columnOf = [&](int64_t time) { return std::min<int64_t>((time - begin) * columns / range, columns - 1); };
+        std::vector<Chunk> straddling; // At most about two per column, however long the range is
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            for (const Chunk& chunk : chunks) {
+                if (chunk.last < begin || chunk.first > end) continue;
+
+                if (chunk.first >= begin && chunk.last <= end && columnOf(chunk.first) == columnOf(chunk.last)) {
+                    result[columnOf(chunk.first)].merge(chunk.summary[metric]);
+                } else {
+                    straddling.push_back(chunk);
+                }
+            }
+        }
+
+        std::vector<station_sample> samples;
+        samples.reserve(TIME_SERIES_CHUNK_SAMPLES);
+
+        for (const Chunk& chunk : straddling) {
+            samples.clear();
+            decode(chunk, samples);
+
+            for (const station_sample& sample : samples) {
+                if (sample.time < begin || sample.time > end) continue;
+                result[columnOf(sample.time)].add(static_cast<int16_t>(sample.value(metric)));
+            }
+        }
+
+        return result;
+    }
+
+    size_t bytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return totalBytes;
+    }
+
+    size_t samples() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return totalSamples;
+    }
+
+    // Time of the oldest sample we still have (or -1 if we don't have any)
+    int64_t oldest() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return chunks.empty() ? -1 : chunks.front().first;
+    }
+
+private:
+    struct Chunk {
+        std::vector<uint8_t> bytes;
+        int64_t first = 0; // Time of the first sample in here
+        int64_t last = 0; // Time of the last sample in here
+        uint32_t count = 0;
+        rssi_bucket summary[station_metric_count] = {}; // Every sample in here, for each metric
+    };
+
+    clock::time_point start;
+    size_t maxBytes;
+    mutable std::mutex mutex;
+    std::deque<Chunk> chunks;
+    size_t totalBytes = 0;
+    size_t totalSamples = 0;
+
+    station_sample previous{}; // The last sample pushed, which the next one is stored relative to
+    int64_t previousDelta = 0; // Spacing between the last two samples
+
+    static uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    static int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    static void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint64_t getVarint(const uint8_t*& in) {
+        uint64_t value = 0;
+        int shift = 0;
+
+        while (*in & 0x80) {
+            value |= static_cast<uint64_t>(*in++ & 0x7F) << shift;
+            shift += 7;
+        }
+
+        value |= static_cast<uint64_t>(*in++) << shift;
+        return value;
+    }
+
+    static void decode(const Chunk& chunk, std::vector<station_sample>& out) {
+        const uint8_t* in = chunk.bytes.data();
+        station_sample sample{};
+        int64_t delta = 0;
+
+        for (uint32_t i = 0; i < chunk.count; i++) {
+            if (i == 0) {
+                sample.time = unzigzag(getVarint(in));
+                sample.rssi = static_cast<int16_t>(unzigzag(getVarint(in)));
+                sample.noise = static_cast<int16_t>(unzigzag(getVarint(in)));
+                sample.rate = static_cast<uint32_t>(getVarint(in));
+            } else {
+                delta += unzigzag(getVarint(in));
+                sample.time += delta;
+                sample.rssi = static_cast<int16_t>(sample.rssi + unzigzag(getVarint(in)));
+                sample.noise = static_cast<int16_t>(sample.noise + unzigzag(getVarint(in)));
+                sample.rate = static_cast<uint32_t>(static_cast<int64_t>(sample.rate) + unzigzag(getVarint(in)));
+            }
+
+            out.push_back(sample);
+        }
+    }
+};
+
+#endif /* TimeSeries_h */
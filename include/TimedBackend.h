@@ -0,0 +1,106 @@
+// ItlwmCLI TimedBackend.h
+// Copyright 2026 by Calebh101
+//
+// Wraps another backend and times every call it makes into a latency histogram per ClientKit call, so 'perf' can tell us which
+// ones are slow (and into the trace, if we're tracing). Whoever makes the call (the refresher, or a command) doesn't need to
+// know it's being timed.
+
+#ifndef TimedBackend_h
+#define TimedBackend_h
+
+#include "Backend.h"
+#include "LatencyHistogram.h"
+#include "Tracer.h"
+#include <chrono>
+#include <memory>
+#include <utility>
+
+// One for every call in Backend.h, named after the ClientKit function it ends up calling
+enum backend_call {
+    backend_call_platform_info,
+    backend_call_power_state,
+    backend_call_80211_state,
+    backend_call_network_ssid,
+    backend_call_network_bssid,
+    backend_call_network_list,
+    backend_call_station_info,
+    backend_call_connect_network,
+    backend_call_power_on,
+    backend_call_power_off,
+    backend_call_associate_ssid,
+    backend_call_disassociate_ssid,
+    backend_call_count,
+};
+
+inline const char* backendCallToString(int call) {
+    switch (call) {
+        case backend_call_platform_info: return "get_platform_info";
+        case backend_call_power_state: return "get_power_state";
+        case backend_call_80211_state: return "get_80211_state";
+        case backend_call_network_ssid: return "get_network_ssid";
+        case backend_call_network_bssid: return "get_network_bssid";
+        case backend_call_network_list: return "get_network_list";
+        case backend_call_station_info: return "get_station_info";
+        case backend_call_connect_network: return "connect_network";
+        case backend_call_power_on: return "power_on";
+        case backend_call_power_off: return "power_off";
+        case backend_call_associate_ssid: return "associate_ssid";
+        case backend_call_disassociate_ssid: return "dis_associate_ssid";
+        default: return "unknown";
+    }
+}
+
+// A histogram for every call
+class BackendLatency {
+public:
+    LatencyHistogram& operator[](int call) { return histograms[call]; }
+    const LatencyHistogram& operator[](int call) const { return histograms[call]; }
+
+    void reset() {
+        for (LatencyHistogram& histogram : histograms) histogram.reset();
+    }
+
+private:
+    LatencyHistogram histograms[backend_call_count];
+};
+
+class TimedBackend : public Backend {
+public:
+    TimedBackend(std::unique_ptr<Backend> inner, BackendLatency& latency, Tracer* tracer = nullptr) : inner(std::move(inner)), latency(latency), tracer(tracer) {}
+
+    std::string name() const override { return inner->name(); }
+
+    bool getPlatformInfo(platform_info_t* result) override { return timed(backend_call_platform_info, [&] { return inner->getPlatformInfo(result); }); }
+    bool getPowerState(bool* enabled) override { return timed(backend_call_power_state, [&] { return inner->getPowerState(enabled); }); }
+    bool get80211State(uint32_t* state) override { return timed(backend_call_80211_state, [&] { return inner->get80211State(state); }); }
+    bool getNetworkSsid(char* ssid) override { return timed(backend_call_network_ssid, [&] { return inner->getNetworkSsid(ssid); }); }
+    bool getNetworkBssid(char* bssid) override { return timed(backend_call_network_bssid, [&] { return inner->getNetworkBssid(bssid); }); }
+    bool getNetworkList(network_info_list_t* list) override { return timed(backend_call_network_list, [&] { return inner->getNetworkList(list); }); }
+    kern_return_t getStationInfo(station_info_t* info) override { return timed(backend_call_station_info, [&] { return inner->getStationInfo(info); }); }
+
+    bool connectNetwork(const char* ssid, const char* pwd) override { return timed(backend_call_connect_network, [&] { return inner->connectNetwork(ssid, pwd); }); }
+    kern_return_t powerOn() override { return timed(backend_call_power_on, [&] { return inner->powerOn(); }); }
+    kern_return_t powerOff() override { return timed(backend_call_power_off, [&] { return inner->powerOff(); }); }
+    kern_return_t associateSsid(const char* ssid, const char* pwd) override { return timed(backend_call_associate_ssid, [&] { return inner->associateSsid(ssid, pwd); }); }
+    kern_return_t disassociateSsid(const char* ssid) override { return timed(backend_call_disassociate_ssid, [&] { return inner->disassociateSsid(ssid); }); }
+
+    void terminate() override { inner->terminate(); }
+
+private:
+    std::unique_ptr<Backend> inner;
+    BackendLatency& latency;
+    Tracer* tracer; // Optional
+
+    template <typename F>
+    auto timed(backend_call call, F&& function) -> decltype(function()) {
+        auto start = std::chrono::steady_clock::now();
+        int64_t traceStart = tracer != nullptr && tracer->active() ? tracer->now() : -1;
+        auto result = function();
+        int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        latency[call].record(micros);
+        if (traceStart >= 0) tracer->record(backendCallToString(call), "ioctl", traceStart, micros);
+        return result;
+    }
+};
+
+#endif /* TimedBackend_h */
@@ -0,0 +1,56 @@
+// ItlwmCLI TimedNode.h
+// Copyright 2026 by Calebh101
+//
+// An FTXUI element that does nothing but time the element inside it. Wrapping the whole screen in one tells us how long FTXUI
+// spends laying out and drawing a frame (as opposed to how long we spent building it). Drawing also shows up in the trace, if
+// we're tracing.
+
+#ifndef TimedNode_h
+#define TimedNode_h
+
+#include "Instrumentation.h"
+#include "Tracer.h"
+#include <ftxui/dom/node.hpp>
+#include <chrono>
+#include <memory>
+
+class TimedNode : public ftxui::Node {
+public:
+    TimedNode(ftxui::Element child, WindowStat& stat, Tracer* tracer = nullptr) : ftxui::Node(ftxui::Elements{std::move(child)}), stat(stat), tracer(tracer) {}
+
+    void ComputeRequirement() override {
+        auto start = std::chrono::steady_clock::now();
+        children_[0]->ComputeRequirement();
+        requirement_ = children_[0]->requirement();
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+
+    void SetBox(ftxui::Box box) override {
+        auto start = std::chrono::steady_clock::now();
+        ftxui::Node::SetBox(box);
+        children_[0]->SetBox(box);
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+
+    // Drawing is the last step, so this is where the frame's time gets recorded
+    void Render(ftxui::Screen& screen) override {
+        auto start = std::chrono::steady_clock::now();
+        int64_t traceStart = tracer != nullptr && tracer->active() ? tracer->now() : -1;
+        children_[0]->Render(screen);
+        if (traceStart >= 0) tracer->record("draw", "ui", traceStart, tracer->now() - traceStart);
+        elapsed += std::chrono::steady_clock::now() - start;
+        stat.record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        elapsed = std::chrono::steady_clock::duration::zero();
+    }
+
+private:
+    WindowStat& stat;
+    Tracer* tracer; // Optional
+    std::chrono::steady_clock::duration elapsed{0};
+};
+
+inline ftxui::Element timed(ftxui::Element child, WindowStat& stat, Tracer* tracer = nullptr) {
+    return std::make_shared<TimedNode>(std::move(child), stat, tracer);
+}
+
+#endif /* TimedNode_h */
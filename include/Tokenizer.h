@@ -0,0 +1,90 @@
+// ItlwmCLI Tokenizer.h
+// Copyright 2026 by Calebh101
+//
+// Splits a command line into arguments without allocating anything. Arguments are separated by whitespace, and can be wrapped
+// in double (") or single (') quotes to keep spaces in them. Inside quotes, a backslash makes the next character literal, so
+// "say \"hi\"" and 'it\'s' work. Tokens point straight into the input, so the input has to outlive them.
+
+#ifndef Tokenizer_h
+#define Tokenizer_h
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum tokenize_status {
+    tokenize_ok,
+    tokenize_unterminated_quote,
+};
+
+struct command_token {
+    std::string_view text; // Without the surrounding quotes
+    bool escaped; // If 'text' still has backslash escapes in it (use unescape() to get the real value)
+};
+
+struct tokenize_result {
+    tokenize_status status;
+    size_t position; // Where the unterminated quote started, if there was one
+};
+
+// Fills 'tokens' (which is cleared first, but keeps its capacity, so reusing one vector means no allocations at all)
+inline tokenize_result tokenize(std::string_view input, std::vector<command_token>& tokens) {
+    tokens.clear();
+    size_t i = 0;
+    size_t length = input.size();
+
+    while (true) {
+        while (i < length && (input[i] == ' ' || input[i] == '\t' || input[i] == '\n' || input[i] == '\r' || input[i] == '\v' || input[i] == '\f')) i++; // Skip whitespace
+        if (i >= length) return {tokenize_ok, 0};
+
+        char c = input[i];
+
+        if (c == '"' || c == '\'') { // Quoted, so it runs until the matching quote
+            size_t start = i;
+            bool escaped = false;
+            i++;
+
+            while (i < length && input[i] != c) {
+                if (input[i] == '\\' && i + 1 < length) {
+                    escaped = true;
+                    i++; // Whatever's next is literal, even if it's a quote
+                }
+
+                i++;
+            }
+
+            if (i >= length) return {tokenize_unterminated_quote, start};
+            tokens.push_back({input.substr(start + 1, i - start - 1), escaped});
+            i++; // Closing quote
+        } else { // Unquoted, so it runs until whitespace (quotes in the middle of it are just characters)
+            size_t start = i;
+            while (i < length && !(input[i] == ' ' || input[i] == '\t' || input[i] == '\n' || input[i] == '\r' || input[i] == '\v' || input[i] == '\f')) i++;
+            tokens.push_back({input.substr(start, i - start), false});
+        }
+    }
+}
+
+// The actual value of a token, with escapes resolved
+inline std::string unescape(const command_token& token) {
+    if (!token.escaped) return std::string(token.text);
+    std::string result;
+    result.reserve(token.text.size());
+
+    for (size_t i = 0; i < token.text.size(); i++) {
+        if (token.text[i] == '\\' && i + 1 < token.text.size()) i++;
+        result += token.text[i];
+    }
+
+    return result;
+}
+
+// Tokenize and unescape in one go, into 'args' (cleared first). 'tokens' is just scratch space, reused between calls.
+inline tokenize_result splitArguments(std::string_view input, std::vector<command_token>& tokens, std::vector<std::string>& args) {
+    tokenize_result result = tokenize(input, tokens);
+    args.clear();
+    if (result.status != tokenize_ok) return result;
+    for (const command_token& token : tokens) args.push_back(unescape(token));
+    return result;
+}
+
+#endif /* Tokenizer_h */
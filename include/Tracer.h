@@ -0,0 +1,219 @@
+// ItlwmCLI Tracer.h
+// Copyright 2026 by Calebh101
+//
+// Records spans (a driver call, a frame, a command) into a Chrome trace file, which chrome://tracing or ui.perfetto.dev can
+// open to show how the threads lined up over time. Off unless we're started with --trace, and when it's off, a span costs one
+// atomic load.
+//
+// Each thread writes into its own arena, so recording a span never takes a lock. When an arena fills up it's handed to a
+// background thread that turns it into JSON and writes it out, and the thread gets an empty one back. Whatever's left in
+// the arenas when we stop gets written then.
+
+#ifndef Tracer_h
+#define Tracer_h
+
+#include <fmt/format.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define TRACE_ARENA_EVENTS 4096  // How many spans a thread holds onto before handing them off to be written
+#define TRACE_DETAIL_LENGTH 64   // How much extra detail a span can carry (like the command that was run), including the terminator
+
+struct trace_event {
+    const char* name; // Has to outlive the tracer (string literals, basically)
+    const char* category;
+    int64_t start; // Microseconds since the tracer started
+    int64_t duration;
+    char detail[TRACE_DETAIL_LENGTH];
+};
+
+class Tracer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    Tracer() : epoch(clock::now()) {}
+
+    ~Tracer() {
+        stop();
+    }
+
+    // Returns false if the file couldn't be opened
+    bool start(const std::string& path) {
+        file = std::fopen(path.c_str(), "w");
+        if (file == nullptr) return false;
+        std::fputs("{\"traceEvents\":[\n", file);
+        stopping = false;
+        writer = std::thread([this] { write(); });
+        enabled = true;
+        return true;
+    }
+
+    // Call once every thread that records spans is done (or at least won't record any more), so their arenas can be emptied
+    void stop() {
+        if (!enabled.exchange(false)) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        signal.notify_one();
+        if (writer.joinable()) writer.join();
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (const auto& arena : arenas) {
+            writeEvents(arena->events, arena->thread);
+            std::fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n", arena->thread, escape(arena->name.c_str()).c_str());
+        }
+
+        std::fputs("{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"ItlwmCLI\"}}\n]}\n", file);
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    bool active() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - epoch).count();
+    }
+
+    // What this thread shows up as in the trace
+    void nameThread(const std::string& name) {
+        Arena* arena = local();
+        std::lock_guard<std::mutex> lock(mutex);
+        arena->name = name;
+    }
+
+    void record(const char* name, const char* category, int64_t start, int64_t duration, const char* detail = nullptr) {
+        if (!active()) return;
+        Arena* arena = local();
+        arena->events.push_back({name, category, start, duration, {0}});
+        if (detail != nullptr) std::strncpy(arena->events.back().detail, detail, TRACE_DETAIL_LENGTH - 1);
+        if (arena->events.size() >= TRACE_ARENA_EVENTS) handOff(arena);
+    }
+
+    // Records a span from when it's made until it goes out of scope
+    class Span {
+    public:
+        Span(Tracer& tracer, const char* name, const char* category, const char* detail = nullptr) : tracer(tracer), name(name), category(category), detail(detail), start(tracer.active() ? tracer.now() : -1) {}
+
+        ~Span() {
+            if (start >= 0) tracer.record(name, category, start, tracer.now() - start, detail);
+        }
+
+    private:
+        Tracer& tracer;
+        const char* name;
+        const char* category;
+        const char* detail; // Copied when the span ends, so it has to last until then
+        int64_t start; // -1 if tracing was off when we started
+    };
+
+private:
+    struct Arena {
+        std::vector<trace_event> events;
+        uint32_t thread;
+        std::string name;
+    };
+
+    clock::time_point epoch;
+    std::atomic<bool> enabled{false};
+    std::FILE* file = nullptr;
+
+    std::mutex mutex; // Guards everything below; only taken when an arena changes hands, never per span
+    std::condition_variable signal;
+    std::thread writer;
+    bool stopping = false;
+    std::vector<std::unique_ptr<Arena>> arenas; // Every thread's, so we can empty them when we stop
+    std::vector<std::pair<std::vector<trace_event>, uint32_t>> full; // Waiting to be written
+    std::vector<std::vector<trace_event>> spare; // Already written, ready to be reused
+    uint32_t nextThread = 1;
+
+    Arena* local() {
+        thread_local Arena* arena = nullptr;
+        if (arena != nullptr) return arena;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        arenas.push_back(std::make_unique<Arena>());
+        arena = arenas.back().get();
+        arena->thread = nextThread++;
+        arena->name = fmt::format("Thread {}", arena->thread);
+        arena->events.reserve(TRACE_ARENA_EVENTS);
+        return arena;
+    }
+
+    void handOff(Arena* arena) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            full.emplace_back(std::move(arena->events), arena->thread);
+
+            if (spare.empty()) {
+                arena->events = std::vector<trace_event>();
+                arena->events.reserve(TRACE_ARENA_EVENTS);
+            } else {
+                arena->events = std::move(spare.back());
+                spare.pop_back();
+            }
+        }
+
+        signal.notify_one();
+    }
+
+    void write() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            signal.wait(lock, [this] { return !full.empty() || stopping; });
+
+            while (!full.empty()) {
+                auto batch = std::move(full.back());
+                full.pop_back();
+                lock.unlock();
+                writeEvents(batch.first, batch.second);
+                batch.first.clear();
+                lock.lock();
+                spare.push_back(std::move(batch.first));
+            }
+
+            if (stopping) return;
+        }
+    }
+
+    void writeEvents(const std::vector<trace_event>& events, uint32_t thread) {
+        std::string out;
+
+        for (const trace_event& event : events) {
+            out += fmt::format("{{\"ph\":\"X\",\"name\":\"{}\",\"cat\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":{},\"dur\":{}", event.name, event.category, thread, event.start, event.duration);
+            if (event.detail[0] != 0) out += fmt::format(",\"args\":{{\"detail\":\"{}\"}}", escape(event.detail));
+            out += "},\n";
+        }
+
+        std::fwrite(out.data(), 1, out.size(), file);
+    }
+
+    static std::string escape(const char* value) {
+        std::string escaped;
+
+        for (const char* c = value; *c != 0; c++) {
+            if (*c == '"' || *c == '\\') escaped += '\\';
+            if (static_cast<unsigned char>(*c) < 0x20) escaped += fmt::format("\\u{:04x}", static_cast<int>(*c));
+            else escaped += *c;
+        }
+
+        return escaped;
+    }
+};
+
+#endif /* Tracer_h */
@@ -0,0 +1,357 @@
+// ItlwmCLI View.h
+// Copyright 2026 by Calebh101
+//
+// Builds what's on screen. Everything a frame shows comes in through a view_input, so nothing in here touches a global or
+// talks to the driver: the renderer in main.cpp gathers it all up and hands it over, and the benchmarks can build frames out
+// of made-up data the same way.
+
+#ifndef View_h
+#define View_h
+
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <fmt/format.h>
+#include "Api.h"
+#include "RingBuffer.h"
+#include "RssiPyramid.h"
+#include "RssiStats.h"
+#include "Snapshot.h"
+#include "TimeSeries.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define RSSI_UNAVAILABLE_THRESHOLD -200  // The RSSI that means unavailable/invalid.
+
+#define HEADER_LINES 2                   // How many lines the header is.
+#define VISIBLE_LOG_LINES 6              // How many lines are used for the command line widget.
+#define VISIBLE_NETWORKS 32              // How many networks should be visible.
+
+#define BAR_WIDTH 2                      // How wide the bars for the real-time signal graph should be.
+#define LOG_INDEX_PADDING 5              // How much to pad the log lines' line numbers with spaces
+
+enum rssi_stage {
+    rssi_stage_excellent,
+    rssi_stage_good,
+    rssi_stage_fair,
+    rssi_stage_poor,
+    rssi_stage_unavailable,
+};
+
+// RSSI is negative, and the closer it is to 0, the better the signal strength
+inline rssi_stage rssiToRssiStage(bool valid, int rssi) {
+    if (!valid) return rssi_stage_unavailable;
+    rssi = abs(rssi);
+
+    if (rssi <= 0) return rssi_stage_unavailable;
+    if (rssi <= 50) return rssi_stage_excellent;
+    if (rssi <= 60) return rssi_stage_good;
+    if (rssi <= 70) return rssi_stage_fair;
+    return rssi_stage_poor;
+}
+
+inline std::string rssiStageToString(rssi_stage stage) {
+    switch (stage) {
+        case rssi_stage_excellent: return "excellent";
+        case rssi_stage_good: return "good";
+        case rssi_stage_fair: return "fair";
+        case rssi_stage_poor: return "poor";
+        case rssi_stage_unavailable: return "unavailable";
+    }
+
+    return "unavailable";
+}
+
+inline ftxui::Color rssiStageToColor(rssi_stage stage) {
+    switch (stage) {
+        case rssi_stage_excellent: return ftxui::Color::Green;
+        case rssi_stage_good: return ftxui::Color::Yellow;
+        case rssi_stage_fair: return ftxui::Color::Orange1;
+        case rssi_stage_poor: return ftxui::Color::Red;
+        case rssi_stage_unavailable: return ftxui::Color::White;
+    }
+
+    return ftxui::Color::White;
+}
+
+inline std::string itlPhyModeToString(bool valid, itl_phy_mode mode) {
+    if (!valid) return "Mode Unavailable";
+
+    switch (mode) {
+        case ITL80211_MODE_11A: return "IEEE 802.11a";
+        case ITL80211_MODE_11B: return "IEEE 802.11b";
+        case ITL80211_MODE_11G: return "IEEE 802.11g";
+        case ITL80211_MODE_11N: return "IEEE 802.11n";
+        case ITL80211_MODE_11AC: return "IEEE 802.11ac";
+        case ITL80211_MODE_11AX: return "IEEE 802.11ax";
+        default: return "Unknown Mode";
+    }
+}
+
+inline std::string parse80211State(bool valid, uint32_t state) {
+    if (!valid) return "Unavailable";
+
+    switch (state) {
+        case ITL80211_S_INIT: return "Idle (Default)";
+        case ITL80211_S_SCAN: return "Scanning...";
+        case ITL80211_S_AUTH: return "Authenticating...";
+        case ITL80211_S_ASSOC: return "Associating...";
+        case ITL80211_S_RUN: return "Running";
+        default: return "Unknown";
+    }
+}
+
+inline std::string stationMetricToString(station_metric metric) {
+    switch (metric) {
+        case station_metric_rssi: return "RSSI";
+        case station_metric_noise: return "noise";
+        case station_metric_rate: return "rate";
+        case station_metric_count: break;
+    }
+
+    return "unknown";
+}
+
+// Milliseconds to something like '30s', '5m', '2h' or '1d', picking the biggest unit that fits evenly
+inline std::string formatDuration(int64_t ms) {
+    if (ms % (24 * 60 * 60 * 1000) == 0) return fmt::format("{}d", ms / (24 * 60 * 60 * 1000));
+    if (ms % (60 * 60 * 1000) == 0) return fmt::format("{}h", ms / (60 * 60 * 1000));
+    if (ms % (60 * 1000) == 0) return fmt::format("{}m", ms / (60 * 1000));
+    return fmt::format("{}s", ms / 1000);
+}
+
+// For sorting networks by RSSI
+inline bool compareNetworkStrength(const ioctl_network_info& a, const ioctl_network_info& b) {
+    return abs(a.rssi) < abs(b.rssi);
+}
+
+// What the graph draws: either the newest raw RSSI values, or buckets (when zoomed out, or showing something other than RSSI)
+struct graph_data {
+    bool bucketed;
+    int minRssi; // Bottom of the graph
+    int maxRssi; // Top of the graph
+    RingBuffer<int16_t>::View live; // When not bucketed
+    std::vector<rssi_bucket> zoomed; // When bucketed, oldest first
+};
+
+// About how many bars fit in the graph next to its labels, for a terminal this wide
+inline int graphColumns(int terminalWidth) {
+    return std::max(1, (terminalWidth / 2 - 7) / BAR_WIDTH);
+}
+
+// Work out the graph's range. For live RSSI that's the stats over everything we've kept; otherwise it's whatever's in the buckets.
+inline void setGraphRange(graph_data& graph, const rssi_summary& summary) {
+    if (graph.bucketed) {
+        rssi_bucket overall{0, 0, 0, 0};
+        for (const rssi_bucket& bucket : graph.zoomed) overall.merge(bucket);
+
+        graph.minRssi = overall.count == 0 ? 0 : overall.min;
+        graph.maxRssi = overall.count == 0 ? 0 : overall.max;
+        if (overall.count > 0 && graph.minRssi == graph.maxRssi) graph.maxRssi = graph.minRssi + 1;
+    } else if (summary.count == 0) {
+        graph.minRssi = 0;
+        graph.maxRssi = 0;
+    } else {
+        graph.minRssi = summary.min; // Minimum graph point (based on the entire dataset)
+        graph.maxRssi = summary.max; // Maximum graph point (based on the entire dataset)
+        if (graph.minRssi == graph.maxRssi) graph.maxRssi = graph.minRssi + 1;
+    }
+}
+
+// Scale the graph's data to 'width' columns and 'height' rows, for FTXUI's graph()
+inline std::vector<int> makeGraph(const graph_data& graph, int width, int height) {
+    std::vector<int> scaled(width, 0);
+    int minRssi = graph.minRssi;
+    int maxRssi = graph.maxRssi;
+
+    if (graph.bucketed) { // One bar per bucket, showing the mean; buckets with nothing in them stay at 0
+        size_t count = std::min(graph.zoomed.size(), static_cast<size_t>(width / BAR_WIDTH));
+        size_t first = graph.zoomed.size() - count;
+        size_t padSize = width - count * BAR_WIDTH;
+        if (maxRssi == minRssi) return scaled;
+
+        for (size_t i = 0; i < count; ++i) {
+            const rssi_bucket& bucket = graph.zoomed[first + i];
+            int y = bucket.count == 0 ? 0 : (bucket.mean() - minRssi) * height / (maxRssi - minRssi);
+            for (size_t j = 0; j < BAR_WIDTH; ++j) scaled[padSize + i * BAR_WIDTH + j] = y;
+        }
+
+        return scaled;
+    }
+
+    if (graph.live.empty()) return scaled; // Empty, we don't have data yet
+    if (maxRssi == minRssi) return scaled;
+    auto data = graph.live.last(width / BAR_WIDTH); // Only the newest ones that fit; still no copying
+
+    size_t padSize = 0;
+    if (data.size() * BAR_WIDTH < static_cast<size_t>(width)) padSize = width - data.size() * BAR_WIDTH; // Padding
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        int rssi = data[i];
+        int y = (rssi - minRssi) * height / (maxRssi - minRssi); // Make it relative
+        if (rssi <= RSSI_UNAVAILABLE_THRESHOLD) y = 0;
+
+        for (size_t j = 0; j < BAR_WIDTH; ++j) { // Make X points, for however wide we want the bars
+            if (padSize + i * BAR_WIDTH + j < scaled.size()) {
+                scaled[padSize + i * BAR_WIDTH + j] = y;
+            }
+        }
+    }
+
+    return scaled;
+}
+
+// Everything a frame needs
+struct view_input {
+    const itlwm_state* state; // The latest snapshot
+    const network_info_list_t* networks; // The scan list, already sorted by strength
+    const std::vector<std::string>* logLines; // Just the visible ones
+    uint64_t firstLine; // Line number of the first visible one (counting from 0)
+    uint64_t totalLines; // How many have ever been logged
+    int logScrolledLeft;
+    rssi_summary rssiSummary;
+    graph_data graph; // Range is filled in by buildView()
+    int64_t graphRange; // 0 for live
+    station_metric graphMetric;
+    std::string title; // Like "ItlwmCLI 1.0.0B Release by Calebh101"
+    std::string commandStatus; // What's running, if anything
+    ftxui::Element input; // The command line's input box
+    std::vector<std::string> overlay; // Stats overlay lines (empty for no overlay)
+    ftxui::Dimensions terminal; // How big the screen is
+};
+
+inline ftxui::Element buildView(view_input& view) {
+    using namespace ftxui;
+
+    Elements output_elements;
+    Elements networks_elements;
+
+    itlwm_snapshot s = view.state->snapshot;
+    const char* localSsid = view.state->ssid;
+    bool currentPowerState = view.state->power;
+    uint32_t current80211State = view.state->state;
+
+    const network_info_list_t& localNetworks = *view.networks;
+    const platform_info_t& localPlatformInfo = view.state->platform;
+    const station_info_t& localStationInfo = view.state->station;
+    const std::vector<std::string>& localOutput = *view.logLines;
+
+    for (size_t i = 0; i < localOutput.size(); ++i) {
+        std::string index = std::to_string(view.firstLine + i + 1);
+        std::string spaces = "";
+        while (index.size() + spaces.size() < LOG_INDEX_PADDING) spaces += " "; // Pad so the line numbers line up correctly
+        output_elements.push_back(text(fmt::format("{}{}.   {}", spaces, index, view.logScrolledLeft >= 0 && localOutput[i].size() > static_cast<size_t>(view.logScrolledLeft) ? localOutput[i].substr(view.logScrolledLeft) : "")));
+    }
+
+    while (output_elements.size() < VISIBLE_LOG_LINES) { // Pad with blanks to keep FTXUI consistent
+        output_elements.insert(output_elements.begin(), text(""));
+    }
+
+    // The driver sometimes hands back a made-up RSSI (like 0) even when the call worked, so that counts as unavailable too
+    s.station_ok = s.station_ok && localStationInfo.rssi < 0 && localStationInfo.rssi > RSSI_UNAVAILABLE_THRESHOLD;
+    bool rssi_available = s.station_ok;
+
+    // If the WiFi is off, then everything should be off
+    if (s.power_ok == false || currentPowerState == false) {
+        s.ssid_ok = false;
+        s.bssid_ok = false;
+        s.state_ok = false;
+        s.platform_ok = false;
+        s.networks_ok = false;
+        s.station_ok = false;
+        rssi_available = false;
+    }
+
+    if (s.state_ok == false || current80211State != ITL80211_S_RUN) rssi_available = false; // If we're not connected, don't record the signal strength
+    rssi_stage rssiStage = rssiToRssiStage(rssi_available, localStationInfo.rssi);
+
+    if (s.networks_ok) {
+        int amount = 0;
+
+        for (int i = 0; i < localNetworks.count; i++) {
+            auto network = localNetworks.networks[i];
+
+            bool emptySsid = std::all_of(std::begin(network.ssid), std::end(network.ssid), [](unsigned char c) {
+                return c == 0;
+            }); // Is the SSID empty? Let's find out!
+
+            if (emptySsid) continue; // If it is, then we skip
+            bool connected = s.ssid_ok ? strcmp(localSsid, reinterpret_cast<char*>(network.ssid)) == 0 : false; // If our current SSID matches the one we're scanning
+
+            std::string ssid(reinterpret_cast<const char*>(network.ssid), strnlen(reinterpret_cast<const char*>(network.ssid), 32)); // fmt is stingy
+            networks_elements.push_back(text(fmt::format("{}. {} (RSSI {}) {} {}", amount + 1, ssid, std::to_string(network.rssi), network.rsn_protos == 0 ? "" : "(locked)", s.ssid_ok && connected ? "(connected)" : "")));
+            amount++;
+        }
+    }
+
+    while (networks_elements.size() < VISIBLE_NETWORKS) { // If we don't hit how many we want, pad the widget
+        networks_elements.push_back(text(""));
+    }
+
+    // Fancy duplication stuff
+    std::stringstream hashtagStream;
+    hashtagStream << std::setw(LOG_INDEX_PADDING) << std::setfill(' ') << std::string(std::to_string(view.totalLines).size(), '#');
+
+    int rssiAverage = view.rssiSummary.average();
+    setGraphRange(view.graph, view.rssiSummary);
+    int minRssi = view.graph.minRssi;
+    int maxRssi = view.graph.maxRssi;
+
+    Element frame = vbox({
+        // Header
+        vbox({
+            text(view.title) | center, // We tell the user if the program is a beta release, a debug binary, or both
+            text(fmt::format("Powered by itlwm {}", s.platform_ok ? localPlatformInfo.driver_info_str: "Unknown")) | center,
+        }) | border | size(HEIGHT, EQUAL, HEADER_LINES + 2),
+        // Body
+        hbox({
+            vbox({
+                // Stats
+                vbox({
+                    text(fmt::format("{}, {}", s.power_ok ? (currentPowerState ? "On" : "Off") : "Unavailable", parse80211State(s.state_ok, current80211State))),
+                    text(fmt::format("{} @{} (channel {})", itlPhyModeToString(s.station_ok, localStationInfo.op_mode), s.platform_ok ? localPlatformInfo.device_info_str : "??", s.station_ok ? std::to_string(localStationInfo.channel) : "unavailable")),
+                    text(fmt::format("Current SSID: {}", s.ssid_ok ? localSsid : "Unavailable")),
+                    text(fmt::format("RSSI: {} ({}) (average: {})", rssi_available ? std::to_string(localStationInfo.rssi) : "Unavailable", rssiStageToString(rssiStage), std::to_string(rssiAverage))),
+                }) | border | size(WIDTH, EQUAL, view.terminal.dimx / 2) | size(HEIGHT, EQUAL, 6),
+                // Graph showing signal strengths
+                vbox({
+                    text(view.graphRange == 0 ? fmt::format("Graph of your {}", stationMetricToString(view.graphMetric)) : fmt::format("Graph of your {} (last {})", stationMetricToString(view.graphMetric), formatDuration(view.graphRange))) | center,
+                    hbox({
+                        vbox({
+                            text(std::to_string(maxRssi)),
+                            filler(),
+                            text(std::to_string(static_cast<int>(std::round((minRssi + maxRssi) / 2.0)))), // Midpoint
+                            filler(),
+                            text(std::to_string(minRssi)),
+                        }) | size(WIDTH, EQUAL, 5),
+                        graph([graph = std::move(view.graph)](int width, int height) { return makeGraph(graph, width, height); }),
+                    }) | flex,
+                }) | border | flex | size(WIDTH, EQUAL, view.terminal.dimx / 2),
+            }),
+            // Shows what networks have been found
+            vbox({
+                networks_elements,
+            }) | border | size(WIDTH, EQUAL, view.terminal.dimx / 2),
+        }) | flex | size(HEIGHT, EQUAL, view.terminal.dimy - VISIBLE_LOG_LINES - HEADER_LINES - 5), // visible log lines, header lines, then 2 for the header border and 3 for the command line border + input
+        // Command line
+        vbox({
+            vbox(output_elements),
+            hbox({text(fmt::format("{}. > ", hashtagStream.str())), view.input | flex, text(view.commandStatus)}),
+        }) | border | size(HEIGHT, EQUAL, VISIBLE_LOG_LINES + 3),
+    });
+
+    if (!view.overlay.empty()) { // Floats over the top right corner
+        Elements lines;
+        for (const std::string& line : view.overlay) lines.push_back(text(line));
+        frame = dbox({frame, vbox({hbox({filler(), vbox(lines) | border | clear_under}), filler()})});
+    }
+
+    return frame;
+}
+
+#endif /* View_h */
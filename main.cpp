@@ -1,41 +1,65 @@
 // ItlwmCLI main.cpp
 // Copyright 2026 by Calebh101
 //
-// This file contains the entire source code for ItlwmCLI.
+// This file contains the app itself. The pieces it's built out of (like the driver backends) live in include/.
 
 #include <ftxui/dom/elements.hpp>
 #include <ftxui/screen/image.hpp>
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include "Api.h"
+#include "Backend.h"
+#include "SimulatedBackend.h"
+#include "TimedBackend.h"
+#include "ReplayBackend.h"
+#include "SubscriberBackend.h"
+#include "Daemon.h"
+#include "SharedSnapshot.h"
+#include "Metrics.h"
+#include "Capture.h"
+#include "Analyze.h"
+#include "Headless.h"
+#include "Snapshot.h"
+#include "PollScheduler.h"
+#include "RedrawLimiter.h"
+#include "RingBuffer.h"
+#include "RssiStats.h"
+#include "RssiPyramid.h"
+#include "TimeSeries.h"
+#include "Tokenizer.h"
+#include "Commands.h"
+#include "CommandExecutor.h"
+#include "LogStore.h"
+#include "LogSink.h"
+#include "Instrumentation.h"
+#include "TimedNode.h"
+#include "Tracer.h"
+#include "View.h"
 #include <iostream>
 #include <string>
 #include <vector>
-#include <deque>
-#include <regex>
 #include <fmt/format.h>
 #include <fstream>
 #include "json.hpp"
 #include "filesystem.hpp"
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
+#include <csignal>
 
 #define VERSION "1.0.0B"                 // Version of the app.
 #define BETA false                       // If the app is in beta.
 
-#define CONSTANT_REFRESH_INTERVAL 50     // How many milliseconds the UI should wait to refresh (<= 0 to disable). Must be a factor of 1000.
-#define RSSI_RECORD_INTERVAL 5           // How many iterations (CONSTANT_REFRESH_INTERVAL) to wait before the RSSI value should be recorded. The actual interval would be (CONSTANT_REFRESH_INTERVAL * RSSI_RECORD_INTERVAL) milliseconds.
+#define CONSTANT_REFRESH_INTERVAL 50     // The shortest amount of milliseconds the refresher waits between polls (<= 0 to disable). How often each value is actually polled is up to PollScheduler.h. Must be a factor of 1000.
+#define RSSI_RECORD_INTERVAL 5           // How many CONSTANT_REFRESH_INTERVALs to wait before the RSSI value should be recorded. The actual interval would be (CONSTANT_REFRESH_INTERVAL * RSSI_RECORD_INTERVAL) milliseconds.
 
-#define RSSI_UNAVAILABLE_THRESHOLD -200  // The RSSI that means unavailable/invalid.
 #define MAX_RSSI_RECORD_LENGTH 10000     // The max length of the RSSI list. After this, new values added chop off the old values.
+#define MAX_LOG_LINES 10000              // How many log lines we keep in memory. Older ones are dropped (or spilled to a file, with --log-spill) a chunk at a time.
+#define LOG_FILE_MB 4                    // How many megabytes the log file (with --log-file) can get to before it's rotated.
+#define STATION_HISTORY_MB 8             // How many megabytes the compressed RSSI/noise/rate history can use (at about 4 bytes a sample, that's days of it).
 
-#define HEADER_LINES 2                   // How many lines the header is.
-#define VISIBLE_LOG_LINES 6              // How many lines are used for the command line widget.
-#define VISIBLE_NETWORKS 32              // How many networks should be visible.
 
-#define BAR_WIDTH 2                      // How wide the bars for the real-time signal graph should be.
 #define TAB_MULTIPLIER 4                 // How many spaces a tab is in the command line widget.
-#define LOG_INDEX_PADDING 5              // How much to pad the log lines' line numbers with spaces
 
 // Make the script aware if it's running in debug mode
 #ifdef __DEBUG
@@ -48,19 +72,20 @@ using namespace ftxui;
 using namespace ghc::filesystem;
 using json = nlohmann::json;
 
-struct itlwm_snapshot {
-    bool ssid_ok;
-    bool bssid_ok;
-    bool state_ok;
-    bool power_ok;
-    bool platform_ok;
-    bool networks_ok;
-    bool station_ok;
-};
+void emitHeadless();
 
+bool headless = false; // If we're printing JSON lines instead of drawing anything (with --headless); set once, before anything starts
 auto screen = ScreenInteractive::TerminalOutput();
-std::vector<std::string> output; // Logs
-std::deque<int16_t> signalRssis; // Signal strengths recorded (for graphs)
+RedrawLimiter redraws([] { headless ? emitHeadless() : screen.PostEvent(Event::Custom); }); // Everything that changes what's on screen (or in headless mode, what we print) goes through this
+LogStore output(MAX_LOG_LINES); // Logs (has its own lock, so it doesn't need 'mutex')
+LogSink logFile; // Every log line, written to a file in the background (with --log-file)
+LogSink spillFile; // Log lines too old to keep in memory, written to a file in the background (with --log-spill)
+RingBuffer<int16_t> signalRssis(MAX_RSSI_RECORD_LENGTH); // Signal strengths recorded (for graphs); only the refresher pushes to it
+RssiStats signalStats(MAX_RSSI_RECORD_LENGTH); // Min/max/average of signalRssis, kept up to date as values come in
+RssiPyramid signalPyramid; // The same values, bucketed at several zoom levels (for graphing long stretches of time)
+std::atomic<int64_t> graphRange{0}; // How many milliseconds the graph shows (0 for live, which is just the newest values)
+std::atomic<int> graphMetric{station_metric_rssi}; // What the graph shows (a station_metric)
+StationSeries stationHistory(STATION_HISTORY_MB * 1024 * 1024); // Compressed long-term RSSI, noise and rate history
 int positionAway = 0; // How far we have scrolled up in the command line widget
 int logScrolledLeft = 0; // How far we've scrolled right in the command line
 std::atomic<bool> running{true}; // If the UI update thread should run
@@ -69,87 +94,63 @@ std::thread refresher; // The UI update thread
 ghc::filesystem::path exec; // Parent directory of the executable
 ghc::filesystem::path settingsfile; // The file path containing our settings (potentially)
 json settings; // Our global settings
-std::mutex mutex; // Mutex for locking
-itlwm_snapshot snapshot{}; // Keeping track of the current snapshot
-
-enum rssi_stage {
-    rssi_stage_excellent,
-    rssi_stage_good,
-    rssi_stage_fair,
-    rssi_stage_poor,
-    rssi_stage_unavailable,
-};
-
-// RSSI is negative, and the closer it is to 0, the better the signal strength
-rssi_stage rssiToRssiStage(bool valid, int rssi) {
-    if (!valid) return rssi_stage_unavailable;
-    rssi = abs(rssi);
-
-    if (rssi <= 0) return rssi_stage_unavailable;
-    if (rssi <= 50) return rssi_stage_excellent;
-    if (rssi <= 60) return rssi_stage_good;
-    if (rssi <= 70) return rssi_stage_fair;
-    return rssi_stage_poor;
+InstrumentedMutex mutex; // Mutex for locking (scroll position and settings; never held while talking to the driver). Keeps track of who waits on it, for the stats overlay.
+SnapshotBuffer<itlwm_state> snapshots; // The latest state the refresher got from itlwm
+std::mutex refreshMutex; // Only for refreshSignal
+std::condition_variable refreshSignal; // Wakes the refresher up early
+bool refreshRequested = false; // If the refresher should poll everything right now (guarded by refreshMutex)
+std::unique_ptr<Backend> backend; // What we talk to itlwm through (the real driver, or the simulator), timed by TimedBackend
+BackendLatency backendLatency; // How long each call to the driver has been taking (see 'perf')
+WindowStat renderBuildTime; // How long the renderer takes to build a frame (and how many frames there have been)
+WindowStat renderDrawTime; // How long FTXUI takes to lay out and draw what the renderer built
+std::atomic<uint64_t> refresherPasses{0}; // How many times the refresher has woken up and polled something
+std::atomic<bool> statsOverlay{false}; // If the stats overlay is showing
+ReplayBackend* replay = nullptr; // The backend, if we're playing back a capture (with --replay); 'backend' owns it
+CaptureWriter recorder; // Every published snapshot, written to a capture (with --record); only the refresher writes to it
+SharedSnapshotWriter sharedSnapshot; // The newest snapshot, in a memory-mapped file (with --shm); only the refresher writes to it
+std::unique_ptr<MetricsExporter> metrics; // Exports metrics for Prometheus (with --metrics-file or --metrics-port)
+std::unique_ptr<SnapshotServer> server; // Every published snapshot, shared with subscribers over a socket (with --daemon)
+Tracer tracer; // Spans for the trace file (with --trace); does nothing otherwise
+std::unique_ptr<HeadlessStream> headlessOutput; // Where JSON lines go (with --headless)
+volatile std::sig_atomic_t stopRequested = 0; // Set by Ctrl-C (or a closed pipe) in headless and daemon modes, since there's no 'exit' to type
+
+// Custom debug function, it just prints to the terminal. We shouldn't use this when the GUI is running. In headless mode it
+// goes to stderr, so stdout is nothing but JSON lines.
+template <typename... Args>
+void debug(const std::string& input, Args&&... args) {
+    (headless ? std::cerr : std::cout) << "ItlwmCLI: " << fmt::format(input, std::forward<Args>(args)...) << std::endl;
 }
 
-std::string rssiStageToString(rssi_stage stage) {
-    switch (stage) {
-        case rssi_stage_excellent: return "excellent";
-        case rssi_stage_good: return "good";
-        case rssi_stage_fair: return "fair";
-        case rssi_stage_poor: return "poor";
-        case rssi_stage_unavailable: return "unavailable";
-    }
+// What the redraw limiter does instead of redrawing in headless mode: print a line, if anything we report changed. Only ever
+// runs on the limiter's thread.
+void emitHeadless() {
+    static itlwm_state current{};
+    snapshots.read(current);
+    if (!headlessOutput->write(current)) stopRequested = 1; // Nobody's reading any more
 }
 
-Color rssiStageToColor(rssi_stage stage) {
-    switch (stage) {
-        case rssi_stage_excellent: return Color::Green;
-        case rssi_stage_good: return Color::Yellow;
-        case rssi_stage_fair: return Color::Orange1;
-        case rssi_stage_poor: return Color::Red;
-        case rssi_stage_unavailable: return Color::White;
+// Make the refresher poll everything right away, instead of whenever it was going to next (like after we change itlwm's state)
+void pokeRefresher() {
+    {
+        std::lock_guard<std::mutex> lock(refreshMutex);
+        refreshRequested = true;
     }
-}
-
-std::string itlPhyModeToString(bool valid, itl_phy_mode mode) {
-    if (!valid) return "Mode Unavailable";
 
-    switch (mode) {
-        case ITL80211_MODE_11A: return "IEEE 802.11a";
-        case ITL80211_MODE_11B: return "IEEE 802.11b";
-        case ITL80211_MODE_11G: return "IEEE 802.11g";
-        case ITL80211_MODE_11N: return "IEEE 802.11n";
-        case ITL80211_MODE_11AC: return "IEEE 802.11ac";
-        case ITL80211_MODE_11AX: return "IEEE 802.11ax";
-        default: return "Unknown Mode";
-    }
+    refreshSignal.notify_one();
 }
 
-std::string parse80211State(bool valid, uint32_t state) {
-    if (!valid) return "Unavailable";
+// Add to command line widget logs ('output')
+void log(std::string input) {
+    InstrumentedMutex::Site site(lock_site_log);
 
-    switch (state) {
-        case ITL80211_S_INIT: return "Idle (Default)";
-        case ITL80211_S_SCAN: return "Scanning...";
-        case ITL80211_S_AUTH: return "Authenticating...";
-        case ITL80211_S_ASSOC: return "Associating...";
-        case ITL80211_S_RUN: return "Running";
-        default: return "Unknown";
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+        if (positionAway != 0) positionAway++; // If we're not following the logs, then scroll even farther away from them to stay where we are now
     }
-}
-
-// Custom debug function, it just prints to the terminal. We shouldn't use this when the GUI is running.
-template <typename... Args>
-void debug(const std::string& input, Args&&... args) {
-    std::cout << "ItlwmCLI: " << fmt::format(input, std::forward<Args>(args)...) << std::endl;
-}
 
-// Add to command line widget logs ('output')
-void log(std::string input) {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (positionAway != 0) positionAway++; // If we're not following the logs, then scroll even farther away from them to stay where we are now
-    output.push_back(input);
+    logFile.push(input); // Does nothing if there's no log file
+    output.append(std::move(input));
+    redraws.request();
 }
 
 // Same thing as the above, but with an indent
@@ -208,20 +209,19 @@ bool saveSettings(json& settings) {
     }
 }
 
-std::vector<std::string> parseCommand(const std::string& input) {
-    std::vector<std::string> args;
-    std::regex re(R"((\"[^\"]*\"|'[^']*'|\S+))"); // Double-quoted strings, single-quoted strings, non-whitespace strings
+// Split a command into its arguments (see Tokenizer.h for the rules). Returns false, after telling the user why, if it couldn't.
+bool parseCommand(const std::string& input, std::vector<std::string>& args) {
+    static thread_local std::vector<command_token> tokens; // Reused, so tokenizing itself never allocates once this has grown a bit
+    tokenize_result result = splitArguments(input, tokens, args);
 
-    auto begin = std::sregex_iterator(input.begin(), input.end(), re); // First match
-    auto end = std::sregex_iterator(); // Last iteration
-
-    for (auto iterator = begin; iterator != end; ++iterator) {
-        std::string arg = iterator->str();
-        if ((arg.front() == '"' && arg.back() == '"') || (arg.front() == '\'' && arg.back() == '\'')) arg = arg.substr(1, arg.length() - 2); // Remove quotes
-        args.push_back(arg);
+    if (result.status == tokenize_unterminated_quote) {
+        log(fmt::format("Unterminated quote at column {}:", result.position + 1));
+        log(1, input);
+        log(1, std::string(result.position, ' ') + "^");
+        return false;
     }
 
-    return args;
+    return true;
 }
 
 inline void trim(std::string& s) {
@@ -235,438 +235,1029 @@ inline void trim(std::string& s) {
 }
 
 template <typename T>
-T atOrDefault(std::vector<T>& input, int i, T _default) {
+T atOrDefault(const std::vector<T>& input, int i, T _default) {
     if (i < input.size()) return input[i];
     return _default;
 }
 
 template <typename T>
-std::optional<T> atOrNull(std::vector<T>& input, int i) {
+std::optional<T> atOrNull(const std::vector<T>& input, int i) {
     if (i < input.size()) return input[i];
     return std::nullopt;
 }
 
-void usage(std::string command = "") {
-    if (command == "settings") {
-        log("settings Usage:");
-        log(1, "settings help                             Print this help message.");
-        log(1, "settings clear                            Delete the app's settings file.");
-        log(1, "settings file [status]                    Decide if you want to allow saving a settings file or not. If a settings file already exists, this is not necessary. 'status' can be 'allow' or 'deny'.");
-    } else if (command == "save" || command == "unsave") {
-        log("save/unsave Usage:");
-        log(1, "save/unsave help                          Print this help message.");
-        log(1, "save/unsave password [SSID] [password]    Save a password for a WiFi network, for use later.");
-    } else if (command.empty()) {
+// Turn something like '30s', '5m', '2h' or '1d' into milliseconds
+std::optional<int64_t> parseDuration(const std::string& input) {
+    if (input.size() < 2) return std::nullopt;
+    int64_t unit;
+
+    switch (input.back()) {
+        case 's': unit = 1000; break;
+        case 'm': unit = 60 * 1000; break;
+        case 'h': unit = 60 * 60 * 1000; break;
+        case 'd': unit = 24 * 60 * 60 * 1000; break;
+        default: return std::nullopt;
+    }
+
+    std::string number = input.substr(0, input.size() - 1);
+    if (!std::all_of(number.begin(), number.end(), [](unsigned char c) { return std::isdigit(c); })) return std::nullopt;
+
+    try {
+        return std::stoll(number) * unit;
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+// Microseconds, in whatever unit reads best
+std::string formatMicros(uint64_t micros) {
+    if (micros < 1000) return fmt::format("{}us", micros);
+    if (micros < 1000000) return fmt::format("{:.2f}ms", micros / 1000.0);
+    return fmt::format("{:.2f}s", micros / 1000000.0);
+}
+
+// What the stats overlay says. Only the renderer calls this; it works out new numbers about once a second and reuses them in between.
+std::vector<std::string> statsOverlayLines() {
+    static std::vector<std::string> lines{"Waiting for numbers..."};
+    static auto last = std::chrono::steady_clock::now();
+    static uint64_t lastPasses = refresherPasses;
+    static uint64_t lastCalls = 0;
+
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - last).count();
+    if (seconds < 1) return lines;
+    last = now;
+
+    uint64_t passes = refresherPasses.load(std::memory_order_relaxed);
+    uint64_t calls = 0;
+    for (int i = 0; i < backend_call_count; i++) calls += backendLatency[i].summary().count;
+
+    window_stat build = renderBuildTime.take();
+    window_stat draw = renderDrawTime.take();
+
+    lines.clear();
+    lines.push_back(fmt::format("Build: {:>9} avg {:>9} max", formatMicros(static_cast<uint64_t>(build.mean())), formatMicros(build.max)));
+    lines.push_back(fmt::format("Draw:  {:>9} avg {:>9} max", formatMicros(static_cast<uint64_t>(draw.mean())), formatMicros(draw.max)));
+    lines.push_back(fmt::format("{:.1f} frames/s, {:.1f} polls/s, {:.1f} calls/s", build.count / seconds, (passes - lastPasses) / seconds, (calls - lastCalls) / seconds));
+    lines.push_back("Lock waits (waited/taken, total, max):");
+
+    for (int site = 0; site < lock_site_count; site++) {
+        window_stat waits = mutex.takeWaits(site);
+        uint64_t taken = mutex.takeAcquisitions(site);
+        lines.push_back(fmt::format("  {:<10} {}/{}, {}, {}", lockSiteToString(site), waits.count, taken, formatMicros(waits.total), formatMicros(waits.max)));
+    }
+
+    lastPasses = passes;
+    lastCalls = calls;
+    return lines;
+}
+
+// Every driver call's latency, for 'perf json' (all times in microseconds)
+json perfJson() {
+    json calls = json::object();
+
+    for (int i = 0; i < backend_call_count; i++) {
+        latency_summary summary = backendLatency[i].summary();
+        calls[backendCallToString(i)] = {{"count", summary.count}, {"p50_us", summary.p50}, {"p90_us", summary.p90}, {"p99_us", summary.p99}, {"max_us", summary.max}, {"mean_us", summary.mean}};
+    }
+
+    return {{"backend", backend->name()}, {"calls", calls}};
+}
+
+CommandRegistry commands; // Every command there is (see registerCommands())
+bool processCommand(std::string input);
+
+// Runs commands off the UI thread, so a slow driver call doesn't freeze everything
+CommandExecutor executor([](const std::string& command) {
+    [[maybe_unused]] static bool named = tracer.active() && (tracer.nameThread("commands"), true); // Only ever one executor thread
+    Tracer::Span traceSpan(tracer, "command", "command", command.c_str());
+    if (!processCommand(command)) log("Invalid command: " + command);
+    if (executor.cancelled()) log(fmt::format("Cancelled '{}'.", command));
+}, [] { redraws.request(); });
+
+// Print help for every command, or for one command (and its subcommands, if it has any)
+void usage(const std::string& command = "") {
+    if (command.empty()) {
         log("Usage:");
-        log(1, "help [command]                            Print this help message, or optionally the help message of a different command.");
-        log(1, "about                                     Show info about ItlwmCLI.");
-        log(1, "exit/e                                    Peacefully exit my tool.");
-        log(1, "power [status]                            Turn WiFi on or off. 'status' can be 'on' or 'off'.");
-        log(1, "connect [ssid] [password]                 Connect to a WiFi network.");
-        log(1, "associate [ssid] [password]               Associate a WiFi network, or make it known to itlwm.");
-        log(1, "disassociate [ssid]                       Disassociate a WiFi network.");
-        log(1, "save/unsave [subcommand]                  Save something for use later, or \"unsave\" (delete) a saved value.");
-        log(1, "settings [subcommand]                     Manage settings.");
-    } else {
+        for (const std::string& line : commands.helpLines()) log(1, line);
+        return;
+    }
+
+    const command_descriptor* descriptor = commands.find(command);
+
+    if (descriptor == nullptr || descriptor->hidden) {
         log(fmt::format("Invalid command: {}", command));
-        log(fmt::format("Tip: Not all commands have a dedicated usage page. Run 'help' for a list of all commands!"));
+        log("Tip: Run 'help' for a list of all commands!");
+        return;
     }
+
+    log(fmt::format("{} Usage:", descriptor->name));
+    for (const std::string& line : descriptor->subcommands ? descriptor->subcommands->helpLines() : std::vector<std::string>{CommandRegistry::helpLine(*descriptor)}) log(1, line);
 }
 
 bool processCommand(std::string input) {
     trim(input);
     if (input.empty()) return true;
-    auto command = parseCommand(input); // The full list of arguments
-    auto action = command[0]; // The thing the user is trying to do, the first argument
+    std::vector<std::string> command; // The full list of arguments
+    if (!parseCommand(input, command) || command.empty()) return true; // parseCommand already said what was wrong
+
+    dispatch_result result = commands.dispatch(command);
+
+    switch (result.status) {
+        case dispatch_ok:
+            break;
+        case dispatch_not_found:
+            return false;
+        case dispatch_bad_arity:
+            log(fmt::format("Command '{}' needs {}.", result.path, CommandRegistry::arityString(*result.command)));
+            break;
+        case dispatch_missing_subcommand:
+            log(fmt::format("A subcommand is required. (Run '{} help' for valid subcommands)", result.path));
+            break;
+        case dispatch_bad_subcommand:
+            log(fmt::format("Invalid subcommand: {} (run '{} help' for valid subcommands)", command[std::count(result.path.begin(), result.path.end(), ' ') + 1], result.path));
+            break;
+    }
+
+    return true; // Something ran (or at least we told the user why it didn't)
+}
+
+// Every SSID we know about: ones we can see right now, and ones we have passwords saved for
+std::vector<std::string> knownSsids() {
+    std::vector<std::string> ssids;
+    static itlwm_state current{}; // Static so we're not putting a whole scan list on the stack
+    snapshots.read(current);
+
+    for (int i = 0; current.snapshot.networks_ok && i < current.networks.count; i++) {
+        const char* ssid = reinterpret_cast<const char*>(current.networks.networks[i].ssid);
+        size_t length = strnlen(ssid, MAX_SSID_LENGTH);
+        if (length > 0) ssids.emplace_back(ssid, length);
+    }
+
+    std::lock_guard<InstrumentedMutex> lock(mutex);
+    if (settings.contains("savedPasswords") && settings["savedPasswords"].is_object()) {
+        for (auto& item : settings["savedPasswords"].items()) ssids.push_back(item.key());
+    }
 
-    if (action == "help") {
-        usage(atOrDefault(command, 1, std::string("")));
-    } else if (action == "about") {
+    return ssids;
+}
+
+// Add a 'help' subcommand to a command's subcommands
+void addSubcommandHelp(CommandRegistry& registry, const std::string& name) {
+    registry.add({"help", {}, 0, 0, name + " help", "Print this help message.", [name](const command_args&) { usage(name); }});
+}
+
+void registerCommands() {
+    commands.add({"help", {}, 0, 1, "help [command]", "Print this help message, or optionally the help message of a different command.", [](const command_args& args) {
+        usage(atOrDefault(args, 1, std::string("")));
+    }, [](const command_args& args) {
+        return args.size() == 2 ? commands.complete(command_args{args[1]}) : std::vector<std::string>{};
+    }});
+
+    commands.add({"about", {}, 0, 0, "about", "Show info about ItlwmCLI.", [](const command_args&) {
         log("ItlwmCLI by Calebh101");
         log(1, fmt::format("Version: {}", VERSION));
         log(1, fmt::format("{} release, {} mode", BETA ? "Beta" : "Stable", DEBUG ? "debug" : "release"));
-    } else if (action == "exit" || action == "e") { // 'e' is helpful, so the user doesn't think Ctrl-C is the only efficient way to exit
+        log(1, fmt::format("Backend: {}", backend->name()));
+    }});
+
+    // 'e' is helpful, so the user doesn't think Ctrl-C is the only efficient way to exit
+    commands.add({"exit", {"e"}, 0, 0, "exit/e", "Peacefully exit my tool.", [](const command_args&) {
         log("Thanks for stopping by!");
         log("Tip: itlwm will still be running even after you exit my program.");
         screen.PostEvent(Event::Custom);
         running = false;
+        pokeRefresher(); // So it notices we're stopping
         if (refresher.joinable()) refresher.join(); // Wait to exit (so we don't crash)
         screen.Exit();
-    } else if (action == "echo") { // Debug command, solely for command parsing tests; won't be listed to the user
-        log(fmt::format("Received command of '{}' with {} extra arguments", action, command.size() - 1));
-    } else if (action == "power") {
-        if (command.size() >= 2) {
-            const std::string status = command[1];
-            int result;
-
-            if (status == "on") {
-                result = power_on();
-            } else if (status == "off") {
-                result = power_off();
-            } else {
-                log("State must be 'on' or 'off'.");
-                return true;
-            }
+    }});
+
+    // Debug command, solely for command parsing tests; won't be listed to the user
+    command_descriptor echo{"echo", {}, 0, -1, "echo [arguments...]", "Say how many arguments were received.", [](const command_args& args) {
+        log(fmt::format("Received command of '{}' with {} extra arguments", args[0], args.size() - 1));
+    }};
 
-            log(fmt::format("Power turned {} with status {}.", status, result));
+    echo.hidden = true;
+    commands.add(echo);
+
+    commands.add({"power", {}, 1, 1, "power [status]", "Turn WiFi on or off. 'status' can be 'on' or 'off'.", [](const command_args& args) {
+        const std::string status = args[1];
+        int result;
+
+        if (status == "on") {
+            result = backend->powerOn();
+        } else if (status == "off") {
+            result = backend->powerOff();
         } else {
-            log("Command 'power' needs 1 argument.");
+            log("State must be 'on' or 'off'.");
+            return;
         }
-    } else if (action == "connect") {
-        if (command.size() >= 2) {
+
+        log(fmt::format("Power turned {} with status {}.", status, result));
+        pokeRefresher();
+    }, [](const command_args& args) {
+        return args.size() == 2 ? std::vector<std::string>{"on", "off"} : std::vector<std::string>{};
+    }});
+
+    auto ssidCompleter = [](const command_args& args) {
+        return args.size() == 2 ? knownSsids() : std::vector<std::string>{};
+    };
+
+    commands.add({"connect", {}, 1, 2, "connect [ssid] [password]", "Connect to a WiFi network.", [](const command_args& args) {
+        std::string ssid = args[1];
+        std::string pswd;
+
+        {
+            std::lock_guard<InstrumentedMutex> lock(mutex);
             if (!settings.contains("savedPasswords") || !settings["savedPasswords"].is_object()) settings["savedPasswords"] = json::object();
-            const std::string ssid = command[1];
-            const std::string pswd = atOrDefault(command, 2, settings["savedPasswords"].value(ssid, "")); // Try to get the 3rd argument, then try to get the saved password, then default to empty
+            pswd = atOrDefault(args, 2, settings["savedPasswords"].value(ssid, "")); // Try to get the 3rd argument, then try to get the saved password, then default to empty
+        }
+
+        log(fmt::format("Connecting to network '{}' with password '{}'...", ssid, pswd));
+        backend->connectNetwork(ssid.c_str(), pswd.c_str());
+        pokeRefresher();
+    }, ssidCompleter});
+
+    commands.add({"associate", {}, 1, 2, "associate [ssid] [password]", "Associate a WiFi network, or make it known to itlwm.", [](const command_args& args) {
+        std::string ssid = args[1];
+        std::string pswd;
+
+        {
+            std::lock_guard<InstrumentedMutex> lock(mutex);
+            if (!settings.contains("savedPasswords") || !settings["savedPasswords"].is_object()) settings["savedPasswords"] = json::object();
+            pswd = atOrDefault(args, 2, settings["savedPasswords"].value(ssid, "")); // Try to get the 3rd argument, then try to get the saved password, then default to empty
+        }
+
+        log(fmt::format("Associating network '{}' with password '{}'...", ssid, pswd));
+        backend->associateSsid(ssid.c_str(), pswd.c_str());
+        pokeRefresher();
+    }, ssidCompleter});
+
+    commands.add({"disassociate", {}, 1, 1, "disassociate [ssid]", "Disassociate a WiFi network.", [](const command_args& args) {
+        const std::string ssid = args[1];
+        log(fmt::format("Disassociating network '{}'...", ssid));
+        backend->disassociateSsid(ssid.c_str());
+        pokeRefresher();
+    }, ssidCompleter});
+
+    auto save = std::make_shared<CommandRegistry>();
+    addSubcommandHelp(*save, "save");
+
+    save->add({"password", {}, 2, 2, "save password [SSID] [password]", "Save a password for a WiFi network, for use later.", [](const command_args& args) {
+        const std::string ssid = args[2];
+        const std::string pswd = args[3];
 
-            log(fmt::format("Connecting to network '{}' with password '{}'...", ssid, pswd));
-            connect_network(ssid.c_str(), pswd.c_str());
+        {
+            std::lock_guard<InstrumentedMutex> lock(mutex);
+            settings["savedPasswords"][ssid] = pswd;
+        }
+
+        saveSettings(settings);
+        log(fmt::format("Saved SSID '{}' with password '{}'!", ssid, pswd));
+    }, [](const command_args& args) {
+        return args.size() == 3 ? knownSsids() : std::vector<std::string>{};
+    }});
+
+    command_descriptor saveCommand{"save", {}, 0, 0, "save [subcommand]", "Save something for use later."};
+    saveCommand.subcommands = save;
+    commands.add(saveCommand);
+
+    auto unsave = std::make_shared<CommandRegistry>();
+    addSubcommandHelp(*unsave, "unsave");
+
+    unsave->add({"password", {}, 1, 1, "unsave password [SSID]", "Delete a saved password.", [](const command_args& args) {
+        const std::string ssid = args[2];
+        bool found = false;
+
+        {
+            std::lock_guard<InstrumentedMutex> lock(mutex);
+            found = settings.contains("savedPasswords") && settings["savedPasswords"].contains(ssid);
+            if (found) settings["savedPasswords"].erase(ssid);
+        }
+
+        if (found) {
+            saveSettings(settings);
+            log(fmt::format("Unsaved SSID '{}'!", ssid));
         } else {
-            log("Command 'connect' needs 1-2 arguments.");
+            log("Provided SSID doesn't have a password saved.");
         }
-    } else if (action == "associate") {
-        if (command.size() >= 2) {
-            if (!settings.contains("savedPasswords") || !settings["savedPasswords"].is_object()) settings["savedPasswords"] = json::object();
-            const std::string ssid = command[1];
-            const std::string pswd = atOrDefault(command, 2, settings["savedPasswords"].value(ssid, "")); // Try to get the 3rd argument, then try to get the saved password, then default to empty
+    }, [](const command_args& args) {
+        std::vector<std::string> ssids;
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+
+        if (args.size() == 3 && settings.contains("savedPasswords") && settings["savedPasswords"].is_object()) {
+            for (auto& item : settings["savedPasswords"].items()) ssids.push_back(item.key());
+        }
+
+        return ssids;
+    }});
+
+    command_descriptor unsaveCommand{"unsave", {}, 0, 0, "unsave [subcommand]", "\"Unsave\" (delete) a saved value."};
+    unsaveCommand.subcommands = unsave;
+    commands.add(unsaveCommand);
 
-            log(fmt::format("Associating network '{}' with password '{}'...", ssid, pswd));
-            associate_ssid(ssid.c_str(), pswd.c_str());
+    auto settingsCommands = std::make_shared<CommandRegistry>();
+    addSubcommandHelp(*settingsCommands, "settings");
+
+    settingsCommands->add({"clear", {}, 0, 0, "settings clear", "Delete the app's settings file.", [](const command_args&) {
+        if (ghc::filesystem::exists(settingsfile) && std::remove(ghc::filesystem::absolute(settingsfile).c_str()) == 0) {
+            log(fmt::format("Settings file at {} removed.", ghc::filesystem::absolute(settingsfile).string()));
         } else {
-            log("Command 'associate' needs 1-2 arguments.");
+            log(fmt::format("Unable to remove settings file at {}. (Does it exist?)", ghc::filesystem::absolute(settingsfile).string()));
         }
-    } else if (action == "disassociate") {
-        if (command.size() >= 2) {
-            const std::string ssid = command[1];
-            log(fmt::format("Disassociating network '{}'...", ssid));
-            dis_associate_ssid(ssid.c_str());
+    }});
+
+    settingsCommands->add({"file", {}, 0, 1, "settings file [status]", "Decide if you want to allow saving a settings file or not. If a settings file already exists, this is not necessary. 'status' can be 'allow' or 'deny'.", [](const command_args& args) {
+        std::optional<std::string> status = atOrNull(args, 2);
+
+        if (status == "allow") {
+            showSaveSettingsPrompt = false;
+            _saveSettings(settings);
+            log("Saved settings!");
+        } else if (status == "deny") {
+            showSaveSettingsPrompt = false;
+            log("Declined to save settings.");
         } else {
-            log("Command 'disassociate' needs 1 argument.");
+            log("Please input a valid status.");
         }
-    } else if (action == "save") {
-        std::optional<std::string> subcommand = atOrNull(command, 1);
-
-        if (subcommand == "help") {
-            usage("save");
-        } else if (subcommand == "password") {
-            std::optional<std::string> ssid = atOrNull(command, 2);
-            std::optional<std::string> pswd = atOrNull(command, 3);
+    }, [](const command_args& args) {
+        return args.size() == 3 ? std::vector<std::string>{"allow", "deny"} : std::vector<std::string>{};
+    }});
+
+    command_descriptor settingsCommand{"settings", {}, 0, 0, "settings [subcommand]", "Manage settings."};
+    settingsCommand.subcommands = settingsCommands;
+    commands.add(settingsCommand);
+
+    commands.add({"graph", {}, 0, 1, "graph [range/metric]", "Show the last 'range' of history in the graph (like '10m', '1h', or '1d'), or 'live' for the newest values. 'metric' can be 'rssi', 'noise' or 'rate'.", [](const command_args& args) {
+        std::optional<std::string> range = atOrNull(args, 1);
+        int64_t maxRange = RssiPyramid::span(PYRAMID_LEVELS - 1) * PYRAMID_BUCKETS;
+
+        if (range == std::nullopt) {
+            int64_t current = graphRange;
+            log(fmt::format("The graph is showing {} ({}).", current == 0 ? "live values" : fmt::format("the last {}", formatDuration(current)), stationMetricToString(static_cast<station_metric>(graphMetric.load()))));
+        } else if (range == "rssi" || range == "noise" || range == "rate") {
+            graphMetric = range == "rssi" ? station_metric_rssi : (range == "noise" ? station_metric_noise : station_metric_rate);
+            log(fmt::format("The graph is now showing {}.", stationMetricToString(static_cast<station_metric>(graphMetric.load()))));
+        } else if (range == "live") {
+            graphRange = 0;
+            log("The graph is now showing live values.");
+        } else {
+            std::optional<int64_t> ms = parseDuration(*range);
 
-            if (ssid == std::nullopt || pswd == std::nullopt) {
-                log("Please provide both an SSID and a password.");
-                return true;
+            if (ms == std::nullopt || *ms <= 0) {
+                log("Please provide a range like '30s', '10m', '1h' or '1d', 'live', or a metric ('rssi', 'noise' or 'rate').");
+            } else if (*ms > maxRange) {
+                log(fmt::format("That's further back than we keep. (The most is {})", formatDuration(maxRange / 1000 * 1000)));
+            } else {
+                graphRange = *ms;
+                log(fmt::format("The graph is now showing the last {}.", formatDuration(*ms)));
             }
+        }
 
-            {
-                std::lock_guard<std::mutex> lock(mutex);
-                settings["savedPasswords"][*ssid] = pswd;
-            }
+        redraws.request();
+    }, [](const command_args& args) {
+        return args.size() == 2 ? std::vector<std::string>{"live", "rssi", "noise", "rate", "1m", "10m", "1h", "1d"} : std::vector<std::string>{};
+    }});
 
-            bool saved = saveSettings(settings);
-            log(fmt::format("Saved SSID '{}' with password '{}'!", ssid.value_or("<unknown>"), pswd.value_or("<unknown>")));
-        } else if (subcommand == std::nullopt) {
-            log("A subcommand is required. (Run 'save help' for valid subcommands)");
-        } else {
-            log(fmt::format("Invalid subcommand: {} (run 'save help' for valid subcommands)", subcommand.value_or("<unknown>")));
+    commands.add({"seek", {}, 0, 1, "seek [time]", "While replaying a capture, jump to 'time' into it (like '90s' or '5m'), or forwards or backwards from where we are with '+' or '-' (like '+30s').", [](const command_args& args) {
+        if (replay == nullptr) {
+            log("Not replaying anything. (Start with --replay [file] to play a capture back.)");
+            return;
+        }
+
+        std::optional<std::string> time = atOrNull(args, 1);
+        int64_t length = replay->length() / 1000;
+
+        if (time == std::nullopt) {
+            log(fmt::format("At {} of {}.", formatDuration(replay->position() / 1000 / 1000 * 1000), formatDuration(length / 1000 * 1000)));
+            return;
+        }
+
+        int sign = time->front() == '+' ? 1 : (time->front() == '-' ? -1 : 0);
+        std::optional<int64_t> ms = parseDuration(sign == 0 ? *time : time->substr(1));
+
+        if (ms == std::nullopt) {
+            log("Please provide a time like '90s' or '5m', or '+30s' or '-1m' to move from where we are.");
+            return;
         }
-    } else if (action == "unsave") {
-        std::optional<std::string> subcommand = atOrNull(command, 1);
 
-        if (subcommand == "help") {
-            usage("unsave");
-        } else if (subcommand == "password") {
-            std::optional<std::string> ssid = atOrNull(command, 2);
+        int64_t target = std::clamp<int64_t>(sign == 0 ? *ms : replay->position() / 1000 + sign * *ms, 0, length);
+        replay->seek(target * 1000);
+        pokeRefresher(); // So we don't wait for the next poll to see it
+        log(fmt::format("Jumped to {} of {}.", formatDuration(target / 1000 * 1000), formatDuration(length / 1000 * 1000)));
+    }, [](const command_args& args) {
+        return args.size() == 2 ? std::vector<std::string>{"0s", "+30s", "-30s", "+5m", "-5m"} : std::vector<std::string>{};
+    }});
 
-            if (ssid == std::nullopt) {
-                log("Please provide an SSID.");
-                return true;
+    commands.add({"perf", {}, 0, 2, "perf [json/reset] [file]", "Show how long each driver call has been taking (p50, p99, max and count). 'json' prints the same thing as JSON (or writes it to 'file'), and 'reset' starts over.", [](const command_args& args) {
+        std::optional<std::string> mode = atOrNull(args, 1);
+
+        if (mode == std::nullopt) {
+            log(fmt::format("{:<22}{:>10}{:>12}{:>12}{:>12}", "Call", "Count", "p50", "p99", "Max"));
+
+            for (int i = 0; i < backend_call_count; i++) {
+                latency_summary summary = backendLatency[i].summary();
+                if (summary.count == 0) continue; // Never called, so nothing to say
+                log(1, fmt::format("{:<18}{:>10}{:>12}{:>12}{:>12}", backendCallToString(i), summary.count, formatMicros(summary.p50), formatMicros(summary.p99), formatMicros(summary.max)));
             }
+        } else if (mode == "json") {
+            std::string dump = perfJson().dump();
+            std::optional<std::string> file = atOrNull(args, 2);
 
-            if (settings["savedPasswords"].contains(ssid.value_or(""))) {
-                settings["savedPasswords"].erase(ssid.value_or(""));
-                bool saved = saveSettings(settings);
-                log(fmt::format("Unsaved SSID '{}'!", ssid.value_or("<unknown>")));
+            if (file == std::nullopt) {
+                log(dump);
             } else {
-                log("Provided SSID doesn't have a password saved.");
+                std::ofstream out(*file);
+
+                if (out.is_open() && (out << dump << std::endl)) {
+                    log(fmt::format("Wrote driver call latencies to {}.", *file));
+                } else {
+                    log(fmt::format("Unable to write to {}.", *file));
+                }
             }
-        } else if (subcommand == std::nullopt) {
-            log("A subcommand is required. (Run 'unsave help' for valid subcommands)");
+        } else if (mode == "reset") {
+            backendLatency.reset();
+            log("Driver call latencies reset.");
         } else {
-            log(fmt::format("Invalid subcommand: {} (run 'unsave help' for valid subcommands)", subcommand.value_or("<unknown>")));
-        }
-    } else if (action == "settings") {
-        std::optional<std::string> subcommand = atOrNull(command, 1);
-
-        if (subcommand == "help") {
-            usage("settings");
-        } else if (subcommand == "file") {
-            std::optional<std::string> status = atOrNull(command, 2);
-
-            if (status == "allow") {
-                showSaveSettingsPrompt = false;
-                _saveSettings(settings);
-                log("Saved settings!");
-            } else if (status == "deny") {
-                showSaveSettingsPrompt = false;
-                log("Declined to save settings.");
-            } else {
-                log("Please input a valid status.");
-            }
-        } else if (subcommand == "clear") {
-            if (ghc::filesystem::exists(settingsfile) && std::remove(ghc::filesystem::absolute(settingsfile).c_str()) == 0) {
-                log(fmt::format("Settings file at {} removed.", ghc::filesystem::absolute(settingsfile).string()));
-            } else {
-                log(fmt::format("Unable to remove settings file at {}. (Does it exist?)", ghc::filesystem::absolute(settingsfile).string()));
-            }
-        } else if (subcommand == std::nullopt) {
-            log("A subcommand is required. (Run 'settings help' for valid subcommands)");
+            log("Please provide 'json', 'reset', or nothing.");
+        }
+    }, [](const command_args& args) {
+        return args.size() == 2 ? std::vector<std::string>{"json", "reset"} : std::vector<std::string>{};
+    }});
+
+    commands.add({"stats", {}, 0, 1, "stats [on/off]", "Show or hide the stats overlay (frame times, lock waits, frames and polls per second).", [](const command_args& args) {
+        std::optional<std::string> status = atOrNull(args, 1);
+
+        if (status == std::nullopt || status == "on" || status == "off") {
+            statsOverlay = status == std::nullopt ? !statsOverlay : status == "on";
+            log(fmt::format("Stats overlay {}.", statsOverlay ? "on" : "off"));
         } else {
-            log(fmt::format("Invalid subcommand: {} (run 'settings help' for valid subcommands)", subcommand.value_or("<unknown>")));
+            log("State must be 'on' or 'off'.");
+        }
+    }, [](const command_args& args) {
+        return args.size() == 2 ? std::vector<std::string>{"on", "off"} : std::vector<std::string>{};
+    }});
+
+    commands.add({"history", {}, 0, 0, "history", "Show how much history we're keeping, and how much memory it's using.", [](const command_args&) {
+        size_t samples = stationHistory.samples();
+        size_t bytes = stationHistory.bytes();
+        int64_t oldest = stationHistory.oldest();
+
+        log(fmt::format("Keeping {} samples of RSSI, noise and rate in {} KB (about {:.1f} bytes each, {} MB max).", samples, bytes / 1024, samples == 0 ? 0.0 : static_cast<double>(bytes) / samples, STATION_HISTORY_MB));
+        if (oldest >= 0) log(1, fmt::format("Oldest sample is from {} ago.", formatDuration((stationHistory.now() - oldest) / 1000 * 1000)));
+    }});
+
+    commands.add({"run", {}, 1, 1, "run [file]", "Run every command in a file, one per line. Blank lines and lines starting with '#' are skipped.", [](const command_args& args) {
+        static int depth = 0; // Scripts can run scripts, but not forever
+
+        if (depth >= 8) {
+            log("Scripts are nested too deep; not running any more of them.");
+            return;
+        }
+
+        std::ifstream in(args[1]);
+
+        if (!in.is_open()) {
+            log(fmt::format("Unable to open script: {}", args[1]));
+            return;
         }
-    } else if (action == "save/unsave") {
+
+        auto start = std::chrono::steady_clock::now();
+        std::error_code error;
+        uintmax_t fileSize = ghc::filesystem::file_size(args[1], error);
+        std::string line;
+        int ran = 0;
+        int invalid = 0;
+        depth++;
+
+        while (running && !executor.cancelled() && std::getline(in, line)) {
+            if (depth == 1 && !error && fileSize > 0 && in.tellg() >= 0) executor.setProgress(static_cast<double>(in.tellg()) / fileSize); // Only the outermost script says how far along it is
+            trim(line);
+            if (line.empty() || line.front() == '#') continue;
+            ran++;
+
+            if (!processCommand(line)) {
+                log("Invalid command: " + line);
+                invalid++;
+            }
+        }
+
+        depth--;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        log(fmt::format("Ran {} commands from {} in {} ms ({} invalid).", ran, args[1], elapsed, invalid));
+    }, [](const command_args& args) {
+        std::vector<std::string> files;
+        if (args.size() != 2) return files;
+        std::error_code error;
+
+        for (const auto& entry : ghc::filesystem::directory_iterator(ghc::filesystem::current_path(), error)) {
+            if (entry.is_regular_file(error)) files.push_back(entry.path().filename().string());
+        }
+
+        return files;
+    }});
+
+    command_descriptor saveOrUnsave{"save/unsave", {}, 0, -1, "save/unsave", "", [](const command_args&) {
         log("No silly, I meant either 'save' or 'unsave'");
-    } else {
-        return false;
+    }};
+
+    saveOrUnsave.hidden = true;
+    commands.add(saveOrUnsave);
+}
+
+// Tab completion for the command line. Returns the new input, and fills 'candidates' if there's more than one option.
+std::string completeCommandLine(const std::string& line, std::vector<std::string>& candidates) {
+    std::vector<command_token> tokens;
+    if (tokenize(line, tokens).status != tokenize_ok) return line; // Not touching a half-typed quote
+
+    command_args args;
+    for (const command_token& token : tokens) args.push_back(unescape(token));
+    bool newArgument = line.empty() || std::isspace(static_cast<unsigned char>(line.back())); // Completing a fresh argument, not the last one
+    if (newArgument) args.push_back("");
+
+    candidates = commands.complete(args);
+    if (candidates.empty()) return line;
+
+    size_t start = line.size(); // Where the argument being completed starts
+
+    if (!newArgument) {
+        start = tokens.back().text.data() - line.data();
+        if (start > 0 && (line[start - 1] == '"' || line[start - 1] == '\'') && start + tokens.back().text.size() < line.size()) start--; // Quoted, so the quote goes too
     }
 
-    return true; // So we don't have to specify return true in each command, it's just caught in overflow
+    auto quote = [](const std::string& value) { // Anything with spaces (or quotes) in it needs quoting to come back out the same
+        if (value.find_first_of(" \t\"'\\") == std::string::npos) return value;
+        std::string quoted = "\"";
+
+        for (char c : value) {
+            if (c == '"' || c == '\\') quoted += '\\';
+            quoted += c;
+        }
+
+        return quoted + "\"";
+    };
+
+    if (candidates.size() == 1) return line.substr(0, start) + quote(candidates[0]) + " ";
+
+    // More than one, so go as far as they all agree
+    std::string prefix = candidates[0];
+    for (const std::string& candidate : candidates) prefix = prefix.substr(0, std::mismatch(prefix.begin(), prefix.end(), candidate.begin(), candidate.end()).first - prefix.begin());
+    if (prefix.size() > args.back().size()) return line.substr(0, start) + (prefix.find_first_of(" \t\"'\\") == std::string::npos ? prefix : line.substr(start));
+    return line;
 }
 
-// For sorting networks by RSSI
-bool compareNetworkStrength(const ioctl_network_info& a, const ioctl_network_info& b) {
-    return abs(a.rssi) < abs(b.rssi);
+// Poll one thing into 'value'. If it came back any different than it was (or it worked when it didn't before, or vice versa), bump its version and return true.
+template <typename T, typename F>
+bool pollChanged(T& value, bool& ok, uint32_t& version, F&& poll) {
+    T before;
+    std::memcpy(&before, &value, sizeof(T));
+    bool wasOk = ok;
+
+    ok = poll();
+    bool changed = ok != wasOk || std::memcmp(&before, &value, sizeof(T)) != 0;
+    if (changed) version++;
+    return changed;
+}
+
+// Microseconds as something like '1h 02m 03s', for durations that don't land on a nice round unit
+std::string formatElapsed(int64_t micros) {
+    int64_t seconds = micros / 1000000;
+    if (seconds < 60) return fmt::format("{:.1f}s", micros / 1000000.0);
+    if (seconds < 60 * 60) return fmt::format("{}m {:02}s", seconds / 60, seconds % 60);
+    return fmt::format("{}h {:02}m {:02}s", seconds / 3600, seconds / 60 % 60, seconds % 60);
+}
+
+// 'ItlwmCLI analyze [files...]': crunch captures into a report, without ever starting the UI
+int analyze(int argc, char* argv[]) {
+    bool asJson = false;
+    int threads = 0;
+    CaptureAnalyzer analyzer;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--json") {
+            asJson = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            try {
+                threads = std::stoi(argv[++i]);
+            } catch (...) {
+                debug("Invalid value for --threads: {}", argv[i]);
+                return 1;
+            }
+        } else if (arg == "--help" || arg == "-h") {
+            debug("Usage: ItlwmCLI analyze [options] [files...]");
+            debug("    --json                      Print the report as JSON.");
+            debug("    --threads [n]               How many threads to analyze with (default one per core).");
+            return 0;
+        } else if (!analyzer.add(arg)) {
+            debug("Unable to read capture file: {}", arg);
+            return 1;
+        }
+    }
+
+    if (analyzer.captures().empty()) {
+        debug("No captures to analyze. (Make some with --record [file].)");
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    capture_analysis result = analyzer.run(threads);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Most-seen SSIDs first
+    auto sorted = [](const std::unordered_map<std::string, rssi_distribution>& ssids) {
+        std::vector<std::pair<std::string, const rssi_distribution*>> sorted;
+        for (const auto& ssid : ssids) sorted.push_back({ssid.first, &ssid.second});
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second->total != b.second->total ? a.second->total > b.second->total : a.first < b.first; });
+        return sorted;
+    };
+
+    if (asJson) {
+        auto distributions = [&](const std::unordered_map<std::string, rssi_distribution>& ssids) {
+            json out = json::object();
+
+            for (const auto& ssid : sorted(ssids)) {
+                const rssi_distribution& rssi = *ssid.second;
+                out[toUtf8(ssid.first)] = {{"count", rssi.total}, {"min", rssi.percentile(0)}, {"p10", rssi.percentile(0.1)}, {"p50", rssi.percentile(0.5)}, {"p90", rssi.percentile(0.9)}, {"max", rssi.percentile(1)}, {"mean", rssi.mean()}};
+            }
+
+            return out;
+        };
+
+        json files = json::array();
+        for (const analyze_file& file : analyzer.captures()) files.push_back({{"path", toUtf8(file.path)}, {"records", file.records}, {"duration_us", file.file->endTime() - file.file->startTime()}, {"indexed", file.file->indexed()}});
+
+        json out = {{"files", files}, {"records", result.records}, {"duration_us", result.duration}, {"states_us", result.stateTime}, {"disconnects", result.disconnects}, {"scanned", distributions(result.scanned)}, {"connected", distributions(result.connected)}};
+        std::cout << out.dump(-1, ' ', false, json::error_handler_t::replace) << std::endl; // SSIDs and paths are already UTF-8 (see toUtf8()), but never abort over it
+        return 0;
+    }
+
+    std::cout << fmt::format("Analyzed {} captures ({}, {} records) in {:.2f}s", analyzer.captures().size(), formatElapsed(result.duration), result.records, elapsed) << std::endl;
+    std::cout << std::endl << "Time in each state:" << std::endl;
+
+    for (const auto& state : result.stateTime) {
+        std::cout << fmt::format("    {:<24}{:>14}{:>8.1f}%", state.first, formatElapsed(state.second), result.duration == 0 ? 0.0 : state.second * 100.0 / result.duration) << std::endl;
+    }
+
+    std::cout << std::endl << fmt::format("Disconnects: {}", result.disconnects) << std::endl;
+
+    auto printDistributions = [&](const std::string& title, const std::unordered_map<std::string, rssi_distribution>& ssids) {
+        std::cout << std::endl << title << std::endl;
+        std::cout << fmt::format("    {:<34}{:>10}{:>6}{:>6}{:>6}{:>6}{:>6}", "SSID", "Samples", "Min", "p10", "p50", "p90", "Max") << std::endl;
+
+        for (const auto& ssid : sorted(ssids)) {
+            const rssi_distribution& rssi = *ssid.second;
+            std::cout << fmt::format("    {:<34}{:>10}{:>6}{:>6}{:>6}{:>6}{:>6}", ssid.first, rssi.total, rssi.percentile(0), rssi.percentile(0.1), rssi.percentile(0.5), rssi.percentile(0.9), rssi.percentile(1)) << std::endl;
+        }
+    };
+
+    printDistributions("RSSI by SSID (from scans):", result.scanned);
+    printDistributions("RSSI by SSID (while connected):", result.connected);
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
-    #ifndef __APPLE__
+    if (argc > 1 && std::string(argv[1]) == "analyze") return analyze(argc, argv); // No UI, no driver, just the report
+    #if !defined(__APPLE__) && !defined(ITLWMCLI_SIMULATED)
         debug("This program requires macOS to run."); // No Timmy, this doesn't work on Windows 11
     #endif
 
     auto versionTypeString = DEBUG ? (BETA ? "Beta (Debug)" : "Debug") : (BETA ? "Beta" : "Release");
-    debug("Starting ItlwmCLI version {} {}", VERSION, versionTypeString);
 
     exec = ghc::filesystem::absolute(argv[0]).parent_path();
     settingsfile = exec / "ItlwmCLI.settings.json"; // File for settings, obviously
 
-    // We finally get to the good stuff
-    debug("Loading application...");
-    settings = loadSettings();
+    bool simulate = false; // If we should use the simulated driver instead of the real one
+    simulation_options simulationOptions;
+    int maxFps = DEFAULT_MAX_FPS; // Cap on how many times a second we redraw
+    std::string logPath; // Where to write every log line (if anywhere)
+    std::string tracePath; // Where to write the trace (if anywhere)
+    std::string spillPath; // Where to write log lines that fall out of memory (if anywhere)
+    uint64_t logFileMb = LOG_FILE_MB; // How big the log file gets before it's rotated
+    std::string recordPath; // Where to record snapshots to (if anywhere)
+    std::string shmPath; // Where to map the shared snapshot (if anywhere)
+    std::string replayPath; // What capture to play back instead of talking to a driver (if any)
+    double replaySpeed = 1.0; // How much faster than real time to play it back
+    int headlessRate = HEADLESS_DEFAULT_RATE; // Most JSON lines per second in headless mode
+    std::string metricsPath; // Where to write metrics (if anywhere)
+    int metricsPort = 0; // Where to serve metrics (if anywhere)
+    int metricsInterval = METRICS_DEFAULT_INTERVAL; // Seconds between writes of the metrics file
+    bool daemon = false; // If we're sharing snapshots with subscribers over a socket
+    bool attach = false; // If we're subscribing to a daemon instead of talking to a driver
+    std::string socketPath = defaultSocketPath(); // Where the daemon listens
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::optional<std::string> value = i + 1 < argc ? std::optional<std::string>(argv[i + 1]) : std::nullopt;
+
+        try {
+            if (arg == "--simulate") {
+                simulate = true;
+            } else if (arg == "--simulate-networks" && value) {
+                simulate = true;
+                simulationOptions.networks = std::stoi(*value);
+                i++;
+            } else if (arg == "--simulate-seed" && value) {
+                simulate = true;
+                simulationOptions.seed = std::stoull(*value);
+                i++;
+            } else if (arg == "--max-fps" && value) {
+                maxFps = std::stoi(*value);
+                i++;
+            } else if (arg == "--trace" && value) {
+                tracePath = *value;
+                i++;
+            } else if (arg == "--record" && value) {
+                recordPath = *value;
+                i++;
+            } else if (arg == "--shm" && value) {
+                shmPath = *value;
+                i++;
+            } else if (arg == "--replay" && value) {
+                replayPath = *value;
+                i++;
+            } else if (arg == "--replay-speed" && value) {
+                replaySpeed = std::stod(*value);
+                if (replaySpeed <= 0) throw std::invalid_argument("speed");
+                i++;
+            } else if (arg == "--headless") {
+                headless = true;
+            } else if (arg == "--headless-rate" && value) {
+                headless = true;
+                headlessRate = std::stoi(*value);
+                i++;
+            } else if (arg == "--metrics-file" && value) {
+                metricsPath = *value;
+                i++;
+            } else if (arg == "--metrics-port" && value) {
+                metricsPort = std::stoi(*value);
+                if (metricsPort <= 0 || metricsPort > 65535) throw std::invalid_argument("port");
+                i++;
+            } else if (arg == "--metrics-interval" && value) {
+                metricsInterval = std::stoi(*value);
+                if (metricsInterval <= 0) throw std::invalid_argument("interval");
+                i++;
+            } else if (arg == "--daemon") {
+                daemon = true;
+            } else if (arg == "--attach") {
+                attach = true;
+            } else if (arg == "--socket" && value) {
+                socketPath = *value;
+                i++;
+            } else if (arg == "--stats") {
+                statsOverlay = true;
+            } else if (arg == "--log-spill" && value) {
+                spillPath = *value;
+                i++;
+            } else if (arg == "--log-file" && value) {
+                logPath = *value;
+                i++;
+            } else if (arg == "--log-file-size" && value) {
+                logFileMb = std::stoull(*value);
+                i++;
+            } else if (arg == "--help" || arg == "-h") {
+                debug("Usage: ItlwmCLI [options], or ItlwmCLI analyze [files...] (see ItlwmCLI analyze --help)");
+                debug("    --simulate                  Use a simulated itlwm instead of the real driver.");
+                debug("    --simulate-networks [n]     How many networks the simulated driver should find. (default {})", simulation_options().networks);
+                debug("    --simulate-seed [n]         Seed for the simulated driver; the same seed always plays out the same way.");
+                debug("    --max-fps [n]               Most times per second the screen is redrawn (default {}, <= 0 for no cap).", DEFAULT_MAX_FPS);
+                debug("    --trace [file]              Write a Chrome trace (for chrome://tracing or ui.perfetto.dev) of driver calls, frames and commands.");
+                debug("    --record [file]             Record everything itlwm tells us to a capture file, to play back later with --replay.");
+                debug("    --shm [file]                Keep the newest snapshot in this memory-mapped file, for other programs to read without asking us.");
+                debug("    --replay [file]             Play back a capture made with --record instead of talking to a driver.");
+                debug("    --replay-speed [x]          How much faster than real time to play a capture back (default 1).");
+                debug("    --headless                  Don't draw anything; print a line of JSON to stdout whenever something changes instead.");
+                debug("    --headless-rate [n]         Most lines per second in headless mode (default {}, <= 0 for no cap).", HEADLESS_DEFAULT_RATE);
+                debug("    --metrics-file [file]       Write metrics for Prometheus (node_exporter's textfile collector) to this file.");
+                debug("    --metrics-port [port]       Serve metrics for Prometheus to scrape on 127.0.0.1:[port]/metrics.");
+                debug("    --metrics-interval [s]      Seconds between writes of the metrics file (default {}).", METRICS_DEFAULT_INTERVAL);
+                debug("    --daemon                    Don't draw anything; poll itlwm and share what it says with subscribers over a socket.");
+                debug("    --attach                    Get everything from a daemon instead of polling itlwm ourselves.");
+                debug("    --socket [path]             Where the daemon listens (default {}).", defaultSocketPath());
+                debug("    --stats                     Start with the stats overlay showing (same as the 'stats' command).");
+                debug("    --log-spill [file]          Append log lines to this file once they're too old to keep in memory (past {}).", MAX_LOG_LINES);
+                debug("    --log-file [file]           Append every log line to this file, with timestamps.");
+                debug("    --log-file-size [MB]        How big the log file gets before it's rotated to [file].1 (default {}, 0 to never rotate).", LOG_FILE_MB);
+                return 0;
+            } else {
+                debug("Unknown option: {} (run with --help for options)", arg);
+                return 1;
+            }
+        } catch (...) {
+            debug("Invalid value for {}: {}", arg, value.value_or(""));
+            return 1;
+        }
+    }
+
+    if (daemon && attach) {
+        debug("--daemon and --attach can't be used together.");
+        return 1;
+    }
 
-    // Initialize all of itlwm's blah
-    network_info_list_t networks{};
-    platform_info_t platformInfo{};
-    station_info_t stationInfo{};
+    if (attach && (simulate || !replayPath.empty())) {
+        debug("--attach gets everything from the daemon, so it can't be used with --simulate or --replay.");
+        return 1;
+    }
 
-    char currentSsid[MAX_SSID_LENGTH] = {0};
-    char currentBssid[32] = {0};
-    bool currentPowerState = false;
-    uint32_t current80211State = 0;
+    debug("Starting ItlwmCLI version {} {}", VERSION, versionTypeString);
 
-    unsigned long iteration = 0; // How many times the refresher thread has iterated
-    signed long pastIteration = -1; // Keeping track of "have we already recorded for this iteration?"
-    int minRssi = 0; // Minimum RSSI of the graph
-    int maxRssi = 0; // Maximum RSSI of the graph
-    std::string input_str; // What the user has inputted in the command line widget
+    #ifdef ITLWMCLI_SIMULATED
+        simulate = replayPath.empty() && !attach; // Nothing else to talk to in this build
+    #endif
 
-    debug("Loading widgets...");
-    log("Hello! Welcome to ItlwmCLI! Type 'help' for available commands, 'about' for app info.");
-    InputOption style = InputOption::Default();
+    if (!logPath.empty()) {
+        if (!logFile.start(logPath, logFileMb * 1024 * 1024)) {
+            debug("Unable to open log file: {}", logPath);
+            return 1;
+        }
 
-    style.transform = [](InputState state) {
-        state.element |= bgcolor(Color::Default); // FTXUI puts a weird white background on input elements
-        if (state.is_placeholder) state.element |= color(Color::RGB(128, 128, 128));
-        return state.element;
-    };
+        logFile.push(fmt::format("ItlwmCLI {} {} started", VERSION, versionTypeString));
+    }
 
-    auto input = Input(&input_str, "Type 'help' for available commands. Use up/down, left/right to scroll.", style); // The input provider for the command line widget
+    if (!tracePath.empty()) {
+        if (!tracer.start(tracePath)) {
+            debug("Unable to open trace file: {}", tracePath);
+            return 1;
+        }
 
-    auto renderer = Renderer([&] {
-        std::vector<std::string> localOutput;
-        std::deque<int16_t> localSignalRssis;
-        int localPositionAway;
-        int localLogScrolledLeft;
-        unsigned long localIteration;
+        tracer.nameThread("ui");
+    }
 
-        itlwm_snapshot s;
-        char localSsid[MAX_SSID_LENGTH];
-        char localBssid[32];
+    if (!spillPath.empty()) {
+        if (!spillFile.start(spillPath, 0, false)) {
+            debug("Unable to open log spill file: {}", spillPath);
+            return 1;
+        }
 
-        network_info_list_t localNetworks;
-        platform_info_t localPlatformInfo;
-        station_info_t localStationInfo;
+        output.spillTo([](std::vector<std::string>&& lines) {
+            for (std::string& line : lines) spillFile.push(std::move(line));
+        });
+    }
 
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            s = snapshot;
-            std::strcpy(localSsid, currentSsid);
-            std::strcpy(localBssid, currentBssid);
+    if (!recordPath.empty() && !recorder.start(recordPath)) {
+        debug("Unable to open capture file {}: {}", recordPath, recorder.error());
+        return 1;
+    }
 
-            localNetworks = networks;
-            localPlatformInfo = platformInfo;
-            localStationInfo = stationInfo;
-            localSignalRssis = signalRssis;
-            localOutput = output;
+    if (!shmPath.empty()) {
+        std::string error;
 
-            localPositionAway = positionAway;
-            localLogScrolledLeft = logScrolledLeft;
+        if (!sharedSnapshot.start(shmPath, error)) {
+            debug("Unable to map shared snapshot file {}: {}", shmPath, error);
+            return 1;
         }
+    }
 
-        Elements output_elements;
-        Elements networks_elements;
-
-        int start = static_cast<int>(localOutput.size()) - VISIBLE_LOG_LINES; // Where should we start rendering command logs?
-        bool foundConnected = false; // If one of the networks returned from itlwm is the one we're connected to (it doesn't seem to do this in my testing)
+    if (attach) {
+        auto subscriber = std::make_unique<SubscriberBackend>(socketPath, [] { pokeRefresher(); }); // Whatever comes in shows up right away, instead of at the next poll
 
-        int newStart = start - localPositionAway;
-        if (newStart < 0) newStart = 0;
+        if (!subscriber->start()) {
+            debug("No daemon of ours listening at {} (start one with --daemon)", socketPath);
+            return 1;
+        }
 
-        int toRender = localOutput.size() - localPositionAway;
-        if (toRender < 0) toRender = 0;
+        debug("Attached to daemon at {}", socketPath);
+        backend = std::move(subscriber);
+    } else if (!replayPath.empty()) {
+        auto player = std::make_unique<ReplayBackend>(replaySpeed);
 
-        for (size_t i = newStart; i < toRender; ++i) {
-            std::string index = std::to_string(i + 1);
-            std::string spaces = "";
-            while (index.size() + spaces.size() < LOG_INDEX_PADDING) spaces += " "; // Pad so the line numbers line up correctly
-            output_elements.push_back(text(fmt::format("{}{}.   {}", spaces, index, localOutput[i].size() > localLogScrolledLeft ? localOutput[i].substr(localLogScrolledLeft) : "")));
+        if (!player->open(replayPath)) {
+            debug("Unable to read capture file: {}", replayPath);
+            return 1;
         }
 
-        while (output_elements.size() < VISIBLE_LOG_LINES) { // Pad with blanks to keep FTXUI consistent
-            output_elements.insert(output_elements.begin(), text(""));
+        debug("Replaying {} at {}x", replayPath, replaySpeed);
+        replay = player.get();
+        backend = std::move(player);
+    } else if (simulate) {
+        debug("Using simulated driver ({} networks, seed {})", simulationOptions.networks, simulationOptions.seed);
+        backend = std::make_unique<SimulatedBackend>(simulationOptions);
+    } else {
+        #ifndef ITLWMCLI_SIMULATED
+            backend = std::make_unique<IOKitBackend>();
+        #endif
+    }
+
+    backend = std::make_unique<TimedBackend>(std::move(backend), backendLatency, &tracer); // So 'perf' (and the trace) know how long every call takes
+
+    if (!metricsPath.empty() || metricsPort != 0) {
+        metrics = std::make_unique<MetricsExporter>([](itlwm_state& state) { return snapshots.read(state) != 0; }, backendLatency);
+        std::string error;
+
+        if (!metrics->start(metricsPath, metricsInterval, metricsPort, error)) {
+            debug("Unable to export metrics: {}", error);
+            return 1;
         }
+    }
 
-        // So uh, s.station_ok is always false in my experience for some reason, so we're using a different method
-        s.station_ok = localStationInfo.rssi < 0 && localStationInfo.rssi > RSSI_UNAVAILABLE_THRESHOLD;
-        bool rssi_available = s.station_ok;
+    if (daemon) {
+        server = std::make_unique<SnapshotServer>(*backend, [] { pokeRefresher(); }); // Subscribers' calls change things, so go look
+        std::string error;
 
-        // If the WiFi is off, then everything should be off
-        if (s.power_ok == false || currentPowerState == false) {
-            s.ssid_ok = false;
-            s.bssid_ok = false;
-            s.state_ok = false;
-            s.platform_ok = false;
-            s.networks_ok = false;
-            s.station_ok = false;
-            rssi_available = false;
+        if (!server->start(socketPath, error)) {
+            debug("Unable to listen on {}: {}", socketPath, error);
+            return 1;
         }
+    }
 
-        if (s.state_ok == false || current80211State != ITL80211_S_RUN) rssi_available = false; // If we're not connected, don't record the signal strength
-        rssi_stage rssiStage = rssiToRssiStage(rssi_available, localStationInfo.rssi);
+    // We finally get to the good stuff
+    debug("Loading application...");
+    settings = loadSettings();
+    registerCommands();
 
-        if (s.networks_ok) {
-            std::sort(localNetworks.networks, localNetworks.networks + localNetworks.count, compareNetworkStrength); // Sort
-            int amount = 0;
+    std::string input_str; // What the user has inputted in the command line widget
+    int cursorPosition = 0; // Where the cursor is in the command line widget (so tab completion can move it to the end)
 
-            for (int i = 0; i < localNetworks.count; i++) {
-                auto network = localNetworks.networks[i];
+    debug("Loading widgets...");
+    log("Hello! Welcome to ItlwmCLI! Type 'help' for available commands, 'about' for app info.");
+    InputOption style = InputOption::Default();
 
-                bool emptySsid = std::all_of(std::begin(network.ssid), std::end(network.ssid), [](unsigned char c) {
-                    return c == 0;
-                }); // Is the SSID empty? Let's find out!
+    style.transform = [](InputState state) {
+        state.element |= bgcolor(Color::Default); // FTXUI puts a weird white background on input elements
+        if (state.is_placeholder) state.element |= color(Color::RGB(128, 128, 128));
+        return state.element;
+    };
 
-                if (emptySsid) continue; // If it is, then we skip
-                bool connected = s.ssid_ok ? strcmp(localSsid, reinterpret_cast<char*>(network.ssid)) == 0 : false; // If our current SSID matches the one we're scanning
-                if (connected) foundConnected = true;
+    style.cursor_position = &cursorPosition;
+    auto input = Input(&input_str, "Type 'help' for available commands. Use up/down, left/right to scroll.", style); // The input provider for the command line widget
 
-                std::string ssid(reinterpret_cast<const char*>(network.ssid), strnlen(reinterpret_cast<const char*>(network.ssid), 32)); // fmt is stingy
-                networks_elements.push_back(text(fmt::format("{}. {} (RSSI {}) {} {}", amount + 1, ssid, std::to_string(network.rssi), network.rsn_protos == 0 ? "" : "(locked)", s.ssid_ok && connected ? "(connected)" : "")));
-                amount++;
-            }
+    auto renderer = Renderer([&] {
+        ScopedTimer buildTimer(renderBuildTime); // Until the frame's returned (drawing it is timed by the TimedNode it's wrapped in)
+        Tracer::Span traceSpan(tracer, "render", "ui");
+        InstrumentedMutex::Site site(lock_site_renderer);
+        static std::vector<std::string> localOutput; // Just the lines we're showing; static so it keeps its capacity between frames
+        int localPositionAway;
+        int localLogScrolledLeft;
+
+        static itlwm_state current{}; // Static so we're not putting a whole scan list on the stack every frame
+        static uint64_t currentSequence = 0;
+        if (snapshots.sequence() != currentSequence) currentSequence = snapshots.read(current); // Never waits on the refresher, and doesn't copy anything if nothing's new
+
+        static network_info_list_t sortedNetworks{}; // The scan list, sorted by strength
+        static uint32_t sortedVersion = UINT32_MAX;
+
+        if (current.versions.networks != sortedVersion) { // Only re-sort when the scan list actually changed
+            sortedNetworks.count = current.networks.count;
+            std::copy(current.networks.networks, current.networks.networks + current.networks.count, sortedNetworks.networks);
+            std::sort(sortedNetworks.networks, sortedNetworks.networks + sortedNetworks.count, compareNetworkStrength);
+            sortedVersion = current.versions.networks;
         }
 
-        while (networks_elements.size() < VISIBLE_NETWORKS) { // If we don't hit how many we want, pad the widget
-            networks_elements.push_back(text(""));
+        {
+            std::lock_guard<InstrumentedMutex> lock(mutex);
+            localPositionAway = positionAway;
+            localLogScrolledLeft = logScrolledLeft;
         }
 
-        // Setup stuff for the graph
-        if (localSignalRssis.empty()) {
-            minRssi = 0;
-            maxRssi = 0;
-        } else {
-            minRssi = *std::min_element(localSignalRssis.begin(), localSignalRssis.end()); // Minimum graph point (based on the entire dataset)
-            maxRssi = *std::max_element(localSignalRssis.begin(), localSignalRssis.end()); // Maximum graph point (based on the entire dataset)
-            if (minRssi == maxRssi) maxRssi = minRssi + 1;
-        }
-
-        // Fancy duplication stuff
-        int lastIndexLength = localOutput.size();
-        std::stringstream hashtagStream;
-        hashtagStream << std::setw(LOG_INDEX_PADDING) << std::setfill(' ') << std::string(std::to_string(localOutput.size()).size(), '#');
-
-        // Get average RSSI
-        long long rssiSum = 0;
-        for (int n : localSignalRssis) rssiSum += abs(n);
-        int rssiAverage = localSignalRssis.empty() ? 0 : -static_cast<int>(rssiSum / localSignalRssis.size());
-
-        auto makeGraph = [rssi_available, minRssi, maxRssi, localSignalRssis](int width, int height) -> std::vector<int> {
-            std::vector<int> scaled(width, 0);
-            if (localSignalRssis.empty()) return scaled; // Empty, we don't have data yet
-            std::deque<int16_t> data(localSignalRssis); // Duplicate the list
-            int i;
-
-            if (data.size() * BAR_WIDTH > width) { // Truncate the copied list
-                std::deque<int16_t> subvec(data.end() - width / BAR_WIDTH, data.end());
-                data = subvec;
-            }
+        view_input view;
+        view.state = &current;
+        view.networks = &sortedNetworks;
+        view.logLines = &localOutput;
+        view.firstLine = output.window(localPositionAway, VISIBLE_LOG_LINES, localOutput); // Only copies what's visible
+        view.totalLines = output.total();
+        view.logScrolledLeft = localLogScrolledLeft;
+        view.rssiSummary = signalStats.summary(); // Already worked out as values came in, so this doesn't depend on how much history there is
+        view.graphRange = graphRange;
+        view.graphMetric = static_cast<station_metric>(graphMetric.load());
+        view.title = fmt::format("ItlwmCLI {} {} by Calebh101", VERSION, versionTypeString);
+        view.input = input->Render();
+        view.terminal = Terminal::Size();
+        if (statsOverlay) view.overlay = statsOverlayLines();
+
+        // What the executor's up to, if anything, like "[connect Home-001 | 3.2s | Esc to cancel]"
+        executor_status executing = executor.status();
+
+        if (executing.busy) {
+            static const char spinner[] = {'|', '/', '-', '\\'};
+            std::string progress = executing.progress >= 0 ? fmt::format(" {:.0f}%", executing.progress * 100) : "";
+            std::string queued = executing.queued > 0 ? fmt::format(" (+{} queued)", executing.queued) : "";
+            view.commandStatus = fmt::format(" {} [{}{} | {:.1f}s{} | {}]", spinner[(executing.elapsed.count() / EXECUTOR_TICK_INTERVAL) % 4], executing.command, progress, executing.elapsed.count() / 1000.0, queued, executing.cancelling ? "cancelling" : "Esc to cancel");
+        }
 
-            size_t padSize = 0;
-            if (data.size() < width) padSize = width - data.size() * BAR_WIDTH; // Padding
+        // Zoomed out, or not showing RSSI? Then the graph is made out of buckets from the pyramid (RSSI, which already has
+        // everything bucketed up) or the compressed history (everything else, where we only decode the chunks we need)
+        view.graph.bucketed = view.graphRange > 0 || view.graphMetric != station_metric_rssi;
+        view.graph.live = signalRssis.view(); // Doesn't copy anything, and doesn't need the lock
 
-            for (size_t i = 0; i < data.size(); ++i) {
-                int rssi = data[i];
-                int y = (rssi - minRssi) * height / (maxRssi - minRssi); // Make it relative
-                if (rssi <= RSSI_UNAVAILABLE_THRESHOLD) y = 0;
+        if (view.graph.bucketed) {
+            int columns = graphColumns(view.terminal.dimx);
 
-                for (size_t j = 0; j < BAR_WIDTH; ++j) { // Make X points, for however wide we want the bars
-                    if (padSize + i * BAR_WIDTH + j < scaled.size()) {
-                        scaled[padSize + i * BAR_WIDTH + j] = y;
-                    }
+            if (view.graphMetric == station_metric_rssi) {
+                view.graph.zoomed = signalPyramid.query(signalPyramid.now(), view.graphRange, columns);
+            } else if (view.graphRange > 0) {
+                view.graph.zoomed = stationHistory.query(view.graphMetric, stationHistory.now(), view.graphRange, columns);
+            } else {
+                for (const station_sample& sample : stationHistory.tail(columns)) { // Live, so one bar per sample
+                    rssi_bucket bucket{0, 0, 0, 0};
+                    bucket.add(static_cast<int16_t>(sample.value(view.graphMetric)));
+                    view.graph.zoomed.push_back(bucket);
                 }
             }
+        }
 
-            return scaled;
-        };
-
-        return vbox({
-            // Header
-            vbox({
-                text(fmt::format("ItlwmCLI {} {} by Calebh101", VERSION, versionTypeString)) | center, // We tell the user if the program is a beta release, a debug binary, or both
-                text(fmt::format("Powered by itlwm {}", s.platform_ok ? localPlatformInfo.driver_info_str: "Unknown")) | center,
-            }) | border | size(HEIGHT, EQUAL, HEADER_LINES + 2),
-            // Body
-            hbox({
-                vbox({
-                    // Stats
-                    vbox({
-                        text(fmt::format("{}, {}", s.power_ok ? (currentPowerState ? "On" : "Off") : "Unavailable", parse80211State(s.state_ok, current80211State))),
-                        text(fmt::format("{} @{} (channel {})", itlPhyModeToString(s.station_ok, localStationInfo.op_mode), s.platform_ok ? localPlatformInfo.device_info_str : "??", s.station_ok ? std::to_string(localStationInfo.channel) : "unavailable")),
-                        text(fmt::format("Current SSID: {}", s.ssid_ok ? localSsid : "Unavailable")),
-                        text(fmt::format("RSSI: {} ({}) (average: {})", rssi_available ? std::to_string(localStationInfo.rssi) : "Unavailable", rssiStageToString(rssiStage), std::to_string(rssiAverage))),
-                    }) | border | size(WIDTH, EQUAL, Terminal::Size().dimx / 2) | size(HEIGHT, EQUAL, 6),
-                    // Graph showing signal strengths
-                    vbox({
-                        text("Graph of your RSSI") | center,
-                        hbox({
-                            vbox({
-                                text(std::to_string(maxRssi)),
-                                filler(),
-                                text(std::to_string(static_cast<int>(std::round((minRssi + maxRssi) / 2.0)))), // Midpoint
-                                filler(),
-                                text(std::to_string(minRssi)),
-                            }) | size(WIDTH, EQUAL, 5),
-                            graph(makeGraph),
-                        }) | flex,
-                    }) | border | flex | size(WIDTH, EQUAL, Terminal::Size().dimx / 2),
-                }),
-                // Shows what networks have been found
-                vbox({
-                    networks_elements,
-                }) | border | size(WIDTH, EQUAL, Terminal::Size().dimx / 2),
-            }) | flex | size(HEIGHT, EQUAL, Terminal::Size().dimy - VISIBLE_LOG_LINES - HEADER_LINES - 5), // visible log lines, header lines, then 2 for the header border and 3 for the command line border + input
-            // Command line
-            vbox({
-                vbox(output_elements),
-                hbox({text(fmt::format("{}. > ", hashtagStream.str())), input->Render()}),
-            }) | border | size(HEIGHT, EQUAL, VISIBLE_LOG_LINES + 3),
-        });
+        Element frame = buildView(view);
+        return timed(frame, renderDrawTime, &tracer);
     });
 
     auto interactive = CatchEvent(renderer, [&](Event event) { // Catch events, like keystrokes
@@ -674,7 +1265,7 @@ int main(int argc, char* argv[]) {
             std::string input;
 
             {
-                std::lock_guard<std::mutex> lock(mutex);
+                std::lock_guard<InstrumentedMutex> lock(mutex);
                 trim(input_str);
                 if (input_str.empty()) return true;
                 input = input_str;
@@ -684,15 +1275,33 @@ int main(int argc, char* argv[]) {
             }
 
             log("> " + input);
-            screen.PostEvent(Event::Custom); // Update UI
-            bool valid = processCommand(input);
-            if (!valid) log("Invalid command: " + input);
+            executor.submit(input); // Runs (and says if it was invalid) on the executor's thread
+            return true;
+        }
+
+        if (event == Event::Escape) { // Stop whatever's running, and anything queued behind it
+            if (executor.cancel()) log("Cancelling...");
+            return true;
+        }
+
+        if (event == Event::Tab) { // Complete whatever's being typed
+            std::vector<std::string> candidates;
+            std::string completed = completeCommandLine(input_str, candidates);
+
+            if (completed != input_str) {
+                input_str = completed;
+                cursorPosition = static_cast<int>(input_str.size());
+            } else if (candidates.size() > 1) {
+                log(fmt::format("Options: {}", fmt::join(candidates, ", ")));
+            }
+
             return true;
         }
 
         if (event == Event::ArrowUp || event == Event::ArrowDown || event == Event::ArrowRight || event == Event::ArrowLeft) {
-            std::lock_guard<std::mutex> lock(mutex);
-            int maxScroll = output.size() > VISIBLE_LOG_LINES ? static_cast<int>(output.size() - VISIBLE_LOG_LINES) : 0;
+            std::lock_guard<InstrumentedMutex> lock(mutex);
+            size_t lines = output.size();
+            int maxScroll = lines > VISIBLE_LOG_LINES ? static_cast<int>(lines - VISIBLE_LOG_LINES) : 0;
 
             if (event == Event::ArrowUp && positionAway < maxScroll) positionAway++;
             else if (event == Event::ArrowDown && positionAway > 0) positionAway--;
@@ -713,45 +1322,160 @@ int main(int argc, char* argv[]) {
         debug("Allowing constant refresh...");
 
         refresher = std::thread([&] {
-            while (running) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(CONSTANT_REFRESH_INTERVAL));
+            InstrumentedMutex::Site site(lock_site_refresher);
+            if (tracer.active()) tracer.nameThread("refresher");
+            auto lastStatsRedraw = PollScheduler::clock::time_point(); // So the stats overlay keeps ticking even when nothing else changes
+            PollScheduler scheduler; // Decides what we ask itlwm for on each pass
+            auto next = std::make_unique<itlwm_state>(); // Our private copy; only this thread ever touches it
+            auto lastRecord = PollScheduler::clock::time_point(); // When we last recorded an RSSI value
+            auto recordInterval = std::chrono::milliseconds(CONSTANT_REFRESH_INTERVAL * RSSI_RECORD_INTERVAL);
 
+            while (running) {
                 {
-                    std::lock_guard<std::mutex> lock(mutex);
-                    iteration++;
-
-                    std::memset(currentSsid, 0, sizeof(currentSsid));
-                    std::memset(currentBssid, 0, sizeof(currentBssid));
-
-                    snapshot.ssid_ok = get_network_ssid(currentSsid);
-                    snapshot.bssid_ok = get_network_bssid(currentBssid);
-                    snapshot.state_ok = get_80211_state(&current80211State);
-                    snapshot.power_ok = get_power_state(&currentPowerState);
-                    snapshot.platform_ok = get_platform_info(&platformInfo);
-                    snapshot.networks_ok = get_network_list(&networks);
-                    snapshot.station_ok = get_station_info(&stationInfo);
-
-                    if (iteration % RSSI_RECORD_INTERVAL == 0) {
-                        int16_t rssiCopy = 0;
-                        bool available = stationInfo.rssi < 0 && stationInfo.rssi > RSSI_UNAVAILABLE_THRESHOLD && currentPowerState && current80211State == ITL80211_S_RUN;
-
-                        if (available) {
-                            rssiCopy = stationInfo.rssi;
-                            signalRssis.push_back(rssiCopy);
-                            if (signalRssis.size() > MAX_RSSI_RECORD_LENGTH) signalRssis.pop_front();
-                        }
+                    // Sleep until something's due (but never less than CONSTANT_REFRESH_INTERVAL), or until someone pokes us
+                    std::unique_lock<std::mutex> lock(refreshMutex);
+                    auto wakeAt = std::max(scheduler.nextDue(), PollScheduler::clock::now() + std::chrono::milliseconds(CONSTANT_REFRESH_INTERVAL));
+                    refreshSignal.wait_until(lock, wakeAt, [] { return refreshRequested || !running; });
+
+                    if (refreshRequested) {
+                        refreshRequested = false;
+                        scheduler.wake();
+                    }
+                }
+
+                if (!running) break;
+                auto now = PollScheduler::clock::now();
+                refresherPasses.fetch_add(1, std::memory_order_relaxed);
+                Tracer::Span traceSpan(tracer, "poll", "refresher"); // The rest of this pass
+                itlwm_snapshot okBefore = next->snapshot;
+                bool stationPolled = false;
+                bool changed = false; // If anything at all changed
+                bool visible = false; // If anything that's actually on screen changed
+
+                // No locks in here: these can take as long as the driver wants without holding up the UI
+                if (scheduler.due(poll_source_power, now)) {
+                    visible |= pollChanged(next->power, next->snapshot.power_ok, next->versions.power, [&] { return backend->getPowerState(&next->power); });
+                    scheduler.polled(poll_source_power, now, next->snapshot.power_ok);
+                }
+
+                if (scheduler.due(poll_source_state, now)) {
+                    visible |= pollChanged(next->state, next->snapshot.state_ok, next->versions.state, [&] { return backend->get80211State(&next->state); });
+                    scheduler.polled(poll_source_state, now, next->snapshot.state_ok);
+                }
+
+                // Cadences follow the power and 802.11 states we just got, so switch before deciding on the rest
+                scheduler.setMode(PollScheduler::modeFor(next->snapshot.power_ok, next->power, next->snapshot.state_ok, next->state), now);
+
+                if (scheduler.due(poll_source_ssid, now)) {
+                    visible |= pollChanged(next->ssid, next->snapshot.ssid_ok, next->versions.ssid, [&] {
+                        std::memset(next->ssid, 0, sizeof(next->ssid));
+                        return backend->getNetworkSsid(next->ssid);
+                    });
+
+                    scheduler.polled(poll_source_ssid, now, next->snapshot.ssid_ok);
+                }
+
+                if (scheduler.due(poll_source_bssid, now)) { // We don't show the BSSID, so this one never causes a redraw
+                    changed |= pollChanged(next->bssid, next->snapshot.bssid_ok, next->versions.bssid, [&] {
+                        std::memset(next->bssid, 0, sizeof(next->bssid));
+                        return backend->getNetworkBssid(next->bssid);
+                    });
+
+                    scheduler.polled(poll_source_bssid, now, next->snapshot.bssid_ok);
+                }
+
+                if (scheduler.due(poll_source_platform, now)) {
+                    visible |= pollChanged(next->platform, next->snapshot.platform_ok, next->versions.platform, [&] { return backend->getPlatformInfo(&next->platform); });
+                    scheduler.polled(poll_source_platform, now, next->snapshot.platform_ok);
+                }
+
+                if (scheduler.due(poll_source_networks, now)) {
+                    visible |= pollChanged(next->networks, next->snapshot.networks_ok, next->versions.networks, [&] { return backend->getNetworkList(&next->networks); });
+                    scheduler.polled(poll_source_networks, now, next->snapshot.networks_ok);
+                }
+
+                if (scheduler.due(poll_source_station, now)) {
+                    station_info_t before = next->station;
+                    changed |= pollChanged(next->station, next->snapshot.station_ok, next->versions.station, [&] { return backend->getStationInfo(&next->station) == KERN_SUCCESS; });
+                    visible |= before.rssi != next->station.rssi || before.channel != next->station.channel || before.op_mode != next->station.op_mode; // Noise, rate and such aren't shown
+                    scheduler.polled(poll_source_station, now, next->snapshot.station_ok);
+                    stationPolled = true;
+                }
+
+                if (scheduler.currentMode() == poll_mode_off) { // We're not asking about any of these while the WiFi's off, so don't pretend we know them
+                    next->snapshot.ssid_ok = false;
+                    next->snapshot.bssid_ok = false;
+                    next->snapshot.state_ok = false;
+                    next->snapshot.networks_ok = false;
+                    next->snapshot.station_ok = false;
+                }
+
+                visible |= std::memcmp(&okBefore, &next->snapshot, sizeof(itlwm_snapshot)) != 0;
+                if (changed || visible) {
+                    snapshots.publish(*next); // Nothing new means readers have nothing to copy
+                    if (!recorder.write(*next)) log(fmt::format("Stopped recording: unable to write to {}: {}", recordPath, recorder.error())); // Only what changed since the last one
+                    sharedSnapshot.publish(*next); // Same here
+                    if (server) server->publish(*next); // Same here
+                }
+
+                if (stationPolled && now - lastRecord >= recordInterval) {
+                    bool available = next->station.rssi < 0 && next->station.rssi > RSSI_UNAVAILABLE_THRESHOLD && next->power && next->state == ITL80211_S_RUN;
+
+                    if (available) {
+                        signalRssis.push(next->station.rssi); // Chops off the oldest value by itself once it's full
+                        signalStats.push(next->station.rssi);
+                        signalPyramid.push(next->station.rssi);
+                        stationHistory.push({stationHistory.now(), next->station.rssi, next->station.noise, next->station.rate});
+                        lastRecord = now;
+                        visible = true; // The graph moved
                     }
                 }
 
-                screen.PostEvent(Event::Custom);
+                if (statsOverlay && now - lastStatsRedraw >= std::chrono::seconds(1)) {
+                    visible = true;
+                    lastStatsRedraw = now;
+                }
+
+                if (visible) redraws.request();
             }
         });
     }
 
-    debug("Starting application...");
-    screen.Loop(interactive);
+    if (headless || daemon) {
+        std::signal(SIGINT, [](int) { stopRequested = 1; });
+        std::signal(SIGTERM, [](int) { stopRequested = 1; });
+        std::signal(SIGPIPE, SIG_IGN); // We find out from the write failing instead
+        if (daemon) debug("Serving snapshots on {} (Ctrl-C to stop)...", socketPath);
+
+        if (headless) {
+            debug("Streaming JSON lines to stdout (Ctrl-C to stop)...");
+            headlessOutput = std::make_unique<HeadlessStream>(stdout);
+            redraws.start(headlessRate);
+            redraws.request(); // The first line, so readers know where things stand right away
+        }
+
+        while (running && !stopRequested) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    } else {
+        debug("Starting application...");
+        redraws.start(maxFps);
+        executor.start();
+        screen.Loop(interactive);
+    }
+
     running = false;
+    pokeRefresher();
+    executor.stop();
+    redraws.stop();
     if (refresher.joinable()) refresher.join();
-    api_terminate();
+    if (!recorder.stop()) debug("Unable to finish capture file {}: {}", recordPath, recorder.error()); // The refresher's done writing to it
+    sharedSnapshot.stop(); // Same here
+    if (server) server->stop(); // Same here, and it might still be making a call for someone
+    if (metrics) metrics->stop();
+    tracer.stop(); // Everything that records spans is done by now
+    backend->terminate();
+    logFile.stop(); // Last, so everything above still gets logged (like the refresher's last pass), then writes out whatever's left
+    spillFile.stop();
     return 0;
 }